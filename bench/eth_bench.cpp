@@ -196,6 +196,24 @@ void benchPairing() {
     endStopwatch(testName, start, numIters);
 }
 
+void benchPairingMulti() {
+    for (const int numPairs : {2, 16, 128, 1024}) {
+        string testName = "Pairing with " + std::to_string(numPairs) + " pairs";
+        const int numIters = 10240 / numPairs;
+        vector<tuple<g1, g2>> v;
+        for (int i = 0; i < numPairs; i++) {
+            pairing::add_pair(v, random_g1(), random_g2());
+        }
+
+        auto start = startStopwatch();
+
+        for (int i = 0; i < numIters; i++) {
+            pairing::calculate(v);
+        }
+        endStopwatch(testName, start, numIters);
+    }
+}
+
 void benchG1Add2() {
     string testName = "G1 Addition With different settings";
     cout << endl << testName << endl;
@@ -266,6 +284,94 @@ void benchInverse() {
     endStopwatch(testName, start, numIters);
 }
 
+void benchHashing() {
+    string testName = "Expand message (xmd_sh256, 256 bytes)";
+    const int numIters = 100000;
+    array<uint8_t, 256> buf;
+    vector<uint8_t> msg(32, 0xAB);
+
+    auto start = startStopwatch();
+
+    for (int i = 0; i < numIters; i++) {
+        xmd_sh256(buf.data(), buf.size(), msg.data(), msg.size(), reinterpret_cast<const uint8_t*>(CIPHERSUITE_ID.data()), CIPHERSUITE_ID.size());
+    }
+    endStopwatch(testName, start, numIters);
+
+    testName = "Expand 256 messages at once (xmd_sh256, 256 bytes each)";
+    const int numIters3 = 400;
+    vector<vector<uint8_t>> msgs(256, vector<uint8_t>(32, 0xCD));
+    vector<span<const uint8_t>> spans(msgs.begin(), msgs.end());
+    vector<uint8_t> out(256 * 256);
+
+    start = startStopwatch();
+
+    for (int i = 0; i < numIters3; i++) {
+        xmd_sh256(out.data(), 256, spans, reinterpret_cast<const uint8_t*>(CIPHERSUITE_ID.data()), CIPHERSUITE_ID.size());
+    }
+    endStopwatch(testName, start, numIters3);
+
+    testName = "Derive child secret key (EIP-2333)";
+    const int numIters2 = 1000;
+    array<uint64_t, 4> sk = random_scalar();
+
+    start = startStopwatch();
+
+    for (int i = 0; i < numIters2; i++) {
+        sk = derive_child_sk(sk, i);
+    }
+    endStopwatch(testName, start, numIters2);
+}
+
+void benchHashToG2() {
+    string testName = "Hash to G2 (fromMessage)";
+    const int numMsgs = 256;
+    vector<vector<uint8_t>> msgs(numMsgs);
+    for (int i = 0; i < numMsgs; i++) {
+        msgs[i] = vector<uint8_t>(32, static_cast<uint8_t>(i));
+    }
+
+    auto start = startStopwatch();
+
+    for (int i = 0; i < numMsgs; i++) {
+        fromMessage(msgs[i], CIPHERSUITE_ID);
+    }
+    endStopwatch(testName, start, numMsgs);
+
+    testName = "Hash to G2 (fromMessages, 256 messages)";
+    vector<span<const uint8_t>> spans(msgs.begin(), msgs.end());
+
+    start = startStopwatch();
+
+    fromMessages(spans, CIPHERSUITE_ID);
+    endStopwatch(testName, start, numMsgs);
+}
+
+void benchBatchVerify() {
+    const int numSigs = 64;
+    vector<g1> pks(numSigs);
+    vector<g2> sigs(numSigs);
+    vector<vector<uint8_t>> msgs(numSigs);
+    for (int i = 0; i < numSigs; i++) {
+        array<uint64_t, 4> sk = random_scalar();
+        msgs[i] = vector<uint8_t>(32, static_cast<uint8_t>(i));
+        pks[i] = public_key(sk);
+        sigs[i] = sign(sk, msgs[i]);
+    }
+    vector<span<const uint8_t>> spans(msgs.begin(), msgs.end());
+
+    string testName = "Verify (64 signatures, one by one)";
+    auto start = startStopwatch();
+    for (int i = 0; i < numSigs; i++) {
+        verify(pks[i], msgs[i], sigs[i]);
+    }
+    endStopwatch(testName, start, numSigs);
+
+    testName = "Verify (64 signatures, batch_verify)";
+    start = startStopwatch();
+    batch_verify(pks, spans, sigs);
+    endStopwatch(testName, start, numSigs);
+}
+
 int main(int argc, char* argv[])
 {
     benchG1Add();
@@ -275,7 +381,11 @@ int main(int argc, char* argv[])
     benchG2Mul();
     benchG2WeightedSum();
     benchPairing();
+    benchPairingMulti();
     benchG1Add2();
     benchG2Add2();
     benchInverse();
+    benchHashing();
+    benchHashToG2();
+    benchBatchVerify();
 }
\ No newline at end of file
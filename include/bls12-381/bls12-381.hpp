@@ -6,3 +6,4 @@
 #include <bls12-381/g.hpp>
 #include <bls12-381/pairing.hpp>
 #include <bls12-381/signatures.hpp>
+#include <bls12-381/registry.hpp>
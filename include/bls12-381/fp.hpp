@@ -2,6 +2,7 @@
 #include <cstdint>
 #include <cstring>
 #include <array>
+#include <vector>
 #include <string>
 #include <tuple>
 #include <optional>
@@ -209,6 +210,7 @@ public:
     void mulBy01Assign(const fp2& e0, const fp2& e1);
     fp6 mulBy01(const fp2& e0, const fp2& e1) const;
     fp6 mulBy1(const fp2& e1) const;
+    fp6 mulBy12(const fp2& e1, const fp2& e2) const;
     fp6 mulByNonResidue() const;
     fp6 mulByBaseField(const fp2& e) const;
     template<size_t N> fp6 exp(const std::array<uint64_t, N>& s) const;
@@ -240,6 +242,19 @@ public:
     void toBytesLE(const std::span<uint8_t, 576> out, const from_mont fm = from_mont::yes) const;
     std::array<uint8_t, 576> toBytesBE(const from_mont fm = from_mont::yes) const;
     std::array<uint8_t, 576> toBytesLE(const from_mont fm = from_mont::yes) const;
+    // compressed (T2 torus) encoding, only valid for elements of the cyclotomic subgroup (e.g. pairing results)
+    static std::optional<fp12> fromCompressedBytesBE(const std::span<const uint8_t, 288> in,
+                                                     const conv_opt opt = { .check_valid = true, .to_mont = true });
+    static std::optional<fp12> fromCompressedBytesLE(const std::span<const uint8_t, 288> in,
+                                                     const conv_opt opt = { .check_valid = true, .to_mont = true });
+    static std::optional<std::vector<fp12>> fromCompressedBytesBE(const std::span<const std::array<uint8_t, 288>> in,
+                                                                  const conv_opt opt = { .check_valid = true, .to_mont = true });
+    static std::optional<std::vector<fp12>> fromCompressedBytesLE(const std::span<const std::array<uint8_t, 288>> in,
+                                                                  const conv_opt opt = { .check_valid = true, .to_mont = true });
+    void toCompressedBytesBE(const std::span<uint8_t, 288> out, const from_mont fm = from_mont::yes) const;
+    void toCompressedBytesLE(const std::span<uint8_t, 288> out, const from_mont fm = from_mont::yes) const;
+    std::array<uint8_t, 288> toCompressedBytesBE(const from_mont fm = from_mont::yes) const;
+    std::array<uint8_t, 288> toCompressedBytesLE(const from_mont fm = from_mont::yes) const;
     static fp12 zero();
     static fp12 one();
     bool isZero() const;
@@ -263,12 +278,46 @@ public:
     static std::tuple<fp2, fp2> fp4Square(const fp2& e0, const fp2& e1);
     fp12 inverse() const;
     void mulBy014Assign(const fp2& e0, const fp2& e1, const fp2& e4);
+    static fp12 mul014By014(const fp2& e0, const fp2& e1, const fp2& e4, const fp2& d0, const fp2& d1, const fp2& d4);
+    void mulBy01245Assign(const fp12& e);
     template<size_t N> fp12 exp(const std::array<uint64_t, N>& s) const;
     template<size_t N> fp12 cyclotomicExp(const std::array<uint64_t, N>& s) const;
+    template<size_t N> fp12 cyclotomicExpCompressed(const std::array<uint64_t, N>& s) const;
+    fp12 cyclotomicExpByX() const;                      // exponentiation by the (negative) curve parameter x
+    fp12 cyclotomicSquareCompressed() const;
+    void cyclotomicSquareCompressedAssign();
+    fp12 decompressKarabina() const;
+    static void batchDecompressKarabina(std::span<fp12> e);
     fp12 frobeniusMap(const uint64_t& power) const;
     void frobeniusMapAssign(const uint64_t& power);
 
     static const std::array<fp2, 12> frobeniusCoeffs12;
 };
 
+// inverts all elements in place using a single inversion (Montgomery's trick), zero elements are left as zero
+template<typename T>
+void batchInverse(std::span<T> e)
+{
+    std::vector<T> acc(e.size());
+    T t = T::one();
+    for(size_t i = 0; i < e.size(); i++)
+    {
+        acc[i] = t;
+        if(!e[i].isZero())
+        {
+            t = t.multiply(e[i]);
+        }
+    }
+    t = t.inverse();
+    for(size_t i = e.size(); i-- > 0;)
+    {
+        if(!e[i].isZero())
+        {
+            T inv = t.multiply(acc[i]);
+            t = t.multiply(e[i]);
+            e[i] = inv;
+        }
+    }
+}
+
 } // namespace bls12_381
@@ -4,11 +4,15 @@
 #include <functional>
 #include <optional>
 #include <span>
+#include <vector>
 #include <bls12-381/fp.hpp>
 
 namespace bls12_381
 {
 
+class g1_affine;
+class g2_affine;
+
 // g1 is type for point in G1.
 // g1 is both used for Affine and Jacobian point representation.
 // If z is equal to one the point is considered as in affine form.
@@ -32,6 +36,9 @@ public:
     static std::optional<g1> fromAffineBytesLE(const std::span<const uint8_t, 96> in,
                                                conv_opt opt = { .check_valid = false, .to_mont = true });
     static std::optional<g1> fromCompressedBytesBE(const std::span<const uint8_t, 48> in);
+    // decompresses the concatenated 48 byte encodings of 'packed' into 'out' on up to 'threads' threads, optionally
+    // followed by the batched subgroup check. False if the sizes differ or any point is invalid ('out' is then partial)
+    static bool fromCompressedBytesBE(std::span<const uint8_t> packed, std::span<g1> out, size_t threads = 1, bool checkSubgroup = false);
     void toJacobianBytesBE(const std::span<uint8_t, 144> out, const from_mont fm = from_mont::yes) const;
     void toJacobianBytesLE(const std::span<uint8_t, 144> out, const from_mont fm = from_mont::yes) const;
     void toAffineBytesBE(const std::span<uint8_t, 96> out, const from_mont fm = from_mont::yes) const;
@@ -42,24 +49,37 @@ public:
     std::array<uint8_t, 96> toAffineBytesBE(const from_mont fm = from_mont::yes) const;
     std::array<uint8_t, 96> toAffineBytesLE(const from_mont fm = from_mont::yes) const;
     std::array<uint8_t, 48> toCompressedBytesBE() const;
+    // batch encoders: all points are normalized with a single inversion and their encodings are written back to
+    // back into 'out'. False if out.size() isn't points.size() times the encoding size.
+    static bool toCompressedBytesBE(std::span<const g1> points, std::span<uint8_t> out);
+    static bool toAffineBytesBE(std::span<const g1> points, std::span<uint8_t> out, const from_mont fm = from_mont::yes);
+    static bool toAffineBytesLE(std::span<const g1> points, std::span<uint8_t> out, const from_mont fm = from_mont::yes);
     static g1 zero();
     static g1 one();
     bool isZero() const;
     bool equal(const g1& e) const;
     bool inCorrectSubgroup() const;
+    // all points in the subgroup, up to a 2^-64 error probability (points must be on the curve)
+    static bool batchInCorrectSubgroup(std::span<const g1> points);
+    // sorted indices of the points that are not in the subgroup
+    static std::vector<size_t> batchFindNotInCorrectSubgroup(std::span<const g1> points);
     bool isOnCurve() const;
     bool isAffine() const;
     g1 affine() const;
     g1 add(const g1& e) const;
     void addAssign(const g1& e);
+    g1 add(const g1_affine& e) const;                  // mixed addition
+    void addAssign(const g1_affine& e);
     g1 dbl() const;
     void doubleAssign();
+    void doubleNAssign(uint64_t k);                     // k successive doublings
     g1 negate() const;
     g1 subtract(const g1& e) const;
     void subtractAssign(const g1& e);
     template<size_t N> g1 scale(const std::array<uint64_t, N>& s) const;
     g1 clearCofactor() const;
     g1 glvEndomorphism() const;
+    g1 mulByX() const;                                  // multiplication by the (negative) curve parameter x
     
     // Those operators are defined to support set and map.
     // They are not mathematically correct.
@@ -67,14 +87,41 @@ public:
     auto operator<=>(const g1&) const = default;
    
     static g1 weightedSum(std::span<const g1> points, std::span<const std::array<uint64_t, 4>> scalars, const std::function<void()>& yield = std::function<void()>());
+    static g1 weightedSum(std::span<const g1_affine> points, std::span<const std::array<uint64_t, 4>> scalars, const std::function<void()>& yield = std::function<void()>());
     static g1 mapToCurve(const fp& e);
     static std::tuple<fp, fp> swuMapG1(const fp& e);
     static void isogenyMapG1(fp& x, fp& y);
+    static g1 swuMap(const fp& e);                      // Jacobian point on the 11-isogenous curve, no inversion
+    g1 isogenyMap() const;
 
     static const g1 BASE;
     static const std::array<uint64_t, 1> cofactorEFF;
 };
 
+// g1_affine is a compact (96 byte) G1 point in affine coordinates, for storing many points and as the
+// cheaper operand of mixed additions. The zero point is encoded as (0, 0), which is not on the curve.
+class g1_affine
+{
+
+public:
+    fp x;
+    fp y;
+
+    g1_affine();
+    g1_affine(const fp& x, const fp& y);
+    explicit g1_affine(const g1& p);                    // one inversion, use fromJacobian for many points
+    static std::vector<g1_affine> fromJacobian(std::span<const g1> points);
+    g1 toJacobian() const;
+    void toAffineBytesBE(const std::span<uint8_t, 96> out, const from_mont fm = from_mont::yes) const;
+    void toAffineBytesLE(const std::span<uint8_t, 96> out, const from_mont fm = from_mont::yes) const;
+    void toCompressedBytesBE(const std::span<uint8_t, 48> out) const;
+    static g1_affine zero();
+    bool isZero() const;
+    bool equal(const g1_affine& e) const;
+    bool isOnCurve() const;
+    g1_affine negate() const;
+};
+
 // g2 is type for point in G2.
 // g2 is both used for Affine and Jacobian point representation.
 // If z is equal to one the point is considered as in affine form.
@@ -98,6 +145,9 @@ public:
     static std::optional<g2> fromAffineBytesLE(const std::span<const uint8_t, 192> in,
                                                conv_opt opt = { .check_valid = false, .to_mont = true });
     static std::optional<g2> fromCompressedBytesBE(const std::span<const uint8_t, 96> in);
+    // decompresses the concatenated 96 byte encodings of 'packed' into 'out' on up to 'threads' threads, optionally
+    // followed by the batched subgroup check. False if the sizes differ or any point is invalid ('out' is then partial)
+    static bool fromCompressedBytesBE(std::span<const uint8_t> packed, std::span<g2> out, size_t threads = 1, bool checkSubgroup = false);
     void toJacobianBytesBE(const std::span<uint8_t, 288> out, const from_mont fm = from_mont::yes) const;
     void toJacobianBytesLE(const std::span<uint8_t, 288> out, const from_mont fm = from_mont::yes) const;
     void toAffineBytesBE(const std::span<uint8_t, 192> out, const from_mont fm = from_mont::yes) const;
@@ -108,22 +158,35 @@ public:
     std::array<uint8_t, 192> toAffineBytesBE(const from_mont fm = from_mont::yes) const;
     std::array<uint8_t, 192> toAffineBytesLE(const from_mont fm = from_mont::yes) const;
     std::array<uint8_t, 96> toCompressedBytesBE() const;
+    // batch encoders: all points are normalized with a single inversion and their encodings are written back to
+    // back into 'out'. False if out.size() isn't points.size() times the encoding size.
+    static bool toCompressedBytesBE(std::span<const g2> points, std::span<uint8_t> out);
+    static bool toAffineBytesBE(std::span<const g2> points, std::span<uint8_t> out, const from_mont fm = from_mont::yes);
+    static bool toAffineBytesLE(std::span<const g2> points, std::span<uint8_t> out, const from_mont fm = from_mont::yes);
     static g2 zero();
     static g2 one();
     bool isZero() const;
     bool equal(const g2& e) const;
     bool inCorrectSubgroup() const;
+    // all points in the subgroup, up to a 2^-64 error probability (points must be on the curve)
+    static bool batchInCorrectSubgroup(std::span<const g2> points);
+    // sorted indices of the points that are not in the subgroup
+    static std::vector<size_t> batchFindNotInCorrectSubgroup(std::span<const g2> points);
     bool isOnCurve() const;
     bool isAffine() const;
     g2 affine() const;
     g2 add(const g2& e) const;
     void addAssign(const g2& e);
+    g2 add(const g2_affine& e) const;                  // mixed addition
+    void addAssign(const g2_affine& e);
     g2 dbl() const;
     void doubleAssign();
+    void doubleNAssign(uint64_t k);                     // k successive doublings
     g2 negate() const;
     g2 subtract(const g2& e) const;
     void subtractAssign(const g2& e);
     g2 psi() const;
+    g2 mulByX() const;                                  // multiplication by the (negative) curve parameter x
     template<size_t N> g2 scale(const std::array<uint64_t, N>& s) const;
     g2 clearCofactor() const;
     g2 frobeniusMap(int64_t power) const;
@@ -134,13 +197,38 @@ public:
     auto operator<=>(const g2&) const = default;
 
     static g2 weightedSum(std::span<const g2> points, std::span<const std::array<uint64_t, 4>> scalars, const std::function<void()>& yield = std::function<void()>());
+    static g2 weightedSum(std::span<const g2_affine> points, std::span<const std::array<uint64_t, 4>> scalars, const std::function<void()>& yield = std::function<void()>());
     static g2 mapToCurve(const fp2& e);
     static std::tuple<fp2, fp2> swuMapG2(const fp2& e);
-    //static void isogenyMapG2(fp2& x, fp2& y);
+    static g2 swuMap(const fp2& e);                     // Jacobian point on the 3-isogenous curve, no inversion
     g2 isogenyMap() const;
 
     static const g2 BASE;
     static const std::array<uint64_t, 1> cofactorEFF;
 };
 
+// g2_affine is a compact (192 byte) G2 point in affine coordinates, for storing many points and as the
+// cheaper operand of mixed additions. The zero point is encoded as (0, 0), which is not on the curve.
+class g2_affine
+{
+
+public:
+    fp2 x;
+    fp2 y;
+
+    g2_affine();
+    g2_affine(const fp2& x, const fp2& y);
+    explicit g2_affine(const g2& p);                    // one inversion, use fromJacobian for many points
+    static std::vector<g2_affine> fromJacobian(std::span<const g2> points);
+    g2 toJacobian() const;
+    void toAffineBytesBE(const std::span<uint8_t, 192> out, const from_mont fm = from_mont::yes) const;
+    void toAffineBytesLE(const std::span<uint8_t, 192> out, const from_mont fm = from_mont::yes) const;
+    void toCompressedBytesBE(const std::span<uint8_t, 96> out) const;
+    static g2_affine zero();
+    bool isZero() const;
+    bool equal(const g2_affine& e) const;
+    bool isOnCurve() const;
+    g2_affine negate() const;
+};
+
 } // namespace bls12_381
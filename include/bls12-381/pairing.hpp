@@ -13,16 +13,20 @@ class fp6;
 class fp12;
 class g1;
 class g2;
+class g1_affine;
+class g2_affine;
 
 namespace pairing
 {
     void doubling_step(std::array<fp2, 3>& coeff, g2& r);
     void addition_step(std::array<fp2, 3>& coeff, g2& r, g2& tp);
-    void pre_compute(std::array<std::array<fp2, 3>, 68>& ellCoeffs, g2& twistPoint);
+    void pre_compute(std::array<std::array<fp2, 3>, 68>& ellCoeffs, const g2& twistPoint);
     fp12 miller_loop(std::span<const std::tuple<g1, g2>> pairs, std::function<void()> yield);
     void final_exponentiation(fp12& f);
     fp12 calculate(std::span<const std::tuple<g1, g2>> pairs, std::function<void()> yield = std::function<void()>());
+    fp12 calculate(std::span<const std::tuple<g1_affine, g2_affine>> pairs, std::function<void()> yield = std::function<void()>());
     void add_pair(std::vector<std::tuple<g1, g2>>& pairs, const g1& e1, const g2& e2);
+    void add_pair(std::vector<std::tuple<g1, g2>>& pairs, const g1_affine& e1, const g2_affine& e2);
 } // namespace pairing
 
 } // namespace bls12_381
@@ -0,0 +1,75 @@
+#pragma once
+#include <cstdint>
+#include <cstdlib>
+#include <optional>
+#include <span>
+#include <string>
+#include <vector>
+#include <bls12-381/g.hpp>
+
+namespace bls12_381
+{
+
+class validated_g1;
+
+// A file of validated G1 public keys that is memory mapped instead of parsed, so opening it costs the same for
+// any number of keys. Layout (little endian):
+//
+//   offset  size  field
+//        0     8  magic "BLS1PKRG"
+//        8     4  version (1)
+//       12     4  flags, bit 0: every key passed the on-curve and subgroup checks when the file was written
+//       16     8  number of keys n
+//       24    32  SHA-256 over bytes 0..23 and the key records
+//       56     8  reserved (zero)
+//       64  n*96  key records: affine x || y, each 48 bytes Montgomery LE
+//
+// The key records are toAffineBytesLE(from_mont::no) and can be read back with fromAffineBytesLE and
+// conv_opt{.check_valid = false, .to_mont = false}. On little endian POSIX hosts they have the memory layout of
+// g1_affine, so the keys are handed out in place from a private read-only mapping; elsewhere they are read into
+// memory. The checksum is not a MAC: anyone who can write the file can set the stamp and recompute it, so the file
+// must be as trusted as the process that wrote it. It must also not be modified or truncated while it is open,
+// the mapping does not isolate the registry from writes to the file.
+class pubkey_registry
+{
+public:
+    // Validates all keys (on the curve, in the subgroup, not zero) and writes them to 'path' with the validation
+    // stamp set. Nothing is written if any key is invalid. Returns false on invalid keys or I/O errors.
+    static bool write(const std::string& path, std::span<const g1> keys);
+
+    // Maps the file at 'path' and verifies its checksum, which hashes the whole file. Returns std::nullopt if it
+    // can't be mapped, if its header or size is malformed, if it isn't stamped as validated or if the checksum
+    // doesn't match.
+    static std::optional<pubkey_registry> open(const std::string& path);
+
+    // Trusted-input opt-in: same as open but skips the checksum, so opening is O(1) and a corrupted record goes
+    // unnoticed by keys() and operator[]. validated() of such a registry checks each key instead of trusting the
+    // stamp.
+    static std::optional<pubkey_registry> openUnverified(const std::string& path);
+
+    pubkey_registry(pubkey_registry&& other) noexcept;
+    pubkey_registry& operator=(pubkey_registry&& other) noexcept;
+    pubkey_registry(const pubkey_registry&) = delete;
+    pubkey_registry& operator=(const pubkey_registry&) = delete;
+    ~pubkey_registry();
+
+    size_t size() const;
+    // zero-copy views into the mapping, valid as long as the registry
+    std::span<const g1_affine> keys() const;
+    const g1_affine& operator[](size_t i) const;
+    // key i ready for the verify overloads that skip the checks. Trusts the validation stamp if the checksum was
+    // verified by open, otherwise checks the key and returns std::nullopt if it is zero or invalid.
+    std::optional<validated_g1> validated(size_t i) const;
+
+private:
+    pubkey_registry(const uint8_t* data, size_t mapped, size_t count, bool verified);
+    static std::optional<pubkey_registry> open(const std::string& path, bool verifyChecksum);
+
+    const uint8_t* m_data;                              // the mapping, null if the keys were read into m_copy
+    size_t m_mapped;
+    size_t m_count;
+    bool m_verified;
+    std::vector<g1_affine> m_copy;
+};
+
+} // namespace bls12_381
@@ -7,6 +7,7 @@
 #include <stdexcept>
 #include <bit>
 #include <string_view>
+#include <utility>
 
 #include <bls12-381/fp.hpp>
 #include <bls12-381/g.hpp>
@@ -213,6 +214,114 @@ void rsh(std::array<uint64_t, N>& out, const std::array<uint64_t, N>& in, uint64
     }
 }
 
+// signed digit recoding of a compile-time scalar S, least significant digit first. The non-adjacent form (NAF) has
+// the fewest non-zero digits, but it can be one digit longer than the binary expansion and its negative digits need
+// a negation, so it is only used if it saves additions.
+template<uint64_t S>
+struct digitChain
+{
+    static_assert(S != 0, "digit chain of zero");
+
+    static constexpr std::array<int8_t, 65> nafDigits()
+    {
+        std::array<int8_t, 65> d{};
+        uint64_t carry = 0;
+        for(size_t i = 0; i < 65; i++)
+        {
+            uint64_t b = (i < 64 ? (S >> i) & 1 : 0) + carry;
+            uint64_t next = i < 63 ? (S >> (i + 1)) & 1 : 0;
+            d[i] = 0;
+            carry = b >> 1;
+            if(b == 1)
+            {
+                // 2 - (k mod 4) for odd k
+                d[i] = next ? -1 : 1;
+                carry = next;
+            }
+        }
+        return d;
+    }
+
+    static constexpr size_t nafLength()
+    {
+        size_t l = 0;
+        for(size_t i = 0; i < 65; i++)
+        {
+            l = nafDigits()[i] != 0 ? i + 1 : l;
+        }
+        return l;
+    }
+
+    static constexpr size_t nafWeight()
+    {
+        size_t w = 0;
+        for(int8_t d : nafDigits())
+        {
+            w += d != 0;
+        }
+        return w;
+    }
+
+    static constexpr bool naf = nafWeight() < static_cast<size_t>(std::popcount(S));
+    static constexpr size_t length = naf ? nafLength() : static_cast<size_t>(std::bit_width(S));
+    static constexpr size_t weight = naf ? nafWeight() : static_cast<size_t>(std::popcount(S));
+
+    static constexpr std::array<int8_t, length> digits = []() {
+        std::array<int8_t, length> d{};
+        for(size_t i = 0; i < length; i++)
+        {
+            d[i] = naf ? nafDigits()[i] : static_cast<int8_t>((S >> i) & 1);
+        }
+        return d;
+    }();
+};
+
+// multiplies p by the compile-time scalar S with a fully unrolled left-to-right chain over digitChain<S>.
+// dbl(r, k) doubles r k times in place and add(r, q) adds q to r. neg(p) is only evaluated if the chain has negative
+// digits.
+template<uint64_t S, typename T, typename Dbl, typename Add, typename Neg>
+T mulByConstant(const T& p, Dbl dbl, Add add, Neg neg)
+{
+    using chain = digitChain<S>;
+    // positions of the non-zero digits, most significant first
+    static constexpr std::array<size_t, chain::weight> pos = []() {
+        std::array<size_t, chain::weight> r{};
+        for(size_t i = chain::length, k = 0; i-- > 0;)
+        {
+            if(chain::digits[i] != 0)
+            {
+                r[k++] = i;
+            }
+        }
+        return r;
+    }();
+    T r = p;
+    T n = p;
+    if constexpr(chain::naf)
+    {
+        n = neg(p);
+    }
+    auto step = [&]<size_t I>() {
+        dbl(r, pos[I - 1] - pos[I]);
+        if constexpr(chain::digits[pos[I]] == 1)
+        {
+            add(r, p);
+        }
+        else
+        {
+            add(r, n);
+        }
+    };
+    [&]<size_t... I>(std::index_sequence<I...>) {
+        (step.template operator()<I + 1>(), ...);
+    }(std::make_index_sequence<chain::weight - 1>());
+    if constexpr(pos[chain::weight - 1] > 0)
+    {
+        dbl(r, pos[chain::weight - 1]);
+    }
+    return r;
+}
+
 } // namespace scalar
 
 void bn_divn_low(uint64_t *c, uint64_t *d, uint64_t *a, int sa, uint64_t *b, int sb);
@@ -327,6 +436,39 @@ fp12 fp12::cyclotomicExp(const std::array<uint64_t, N>& s) const
     return z;
 }
 
+template<size_t N>
+fp12 fp12::cyclotomicExpCompressed(const std::array<uint64_t, N>& s) const
+{
+    // right-to-left: the compressed powers g^(2^i) at the set bits are collected,
+    // decompressed together with a single inversion and then multiplied
+    std::vector<fp12> powers;
+    fp12 z = fp12::one();
+    fp12 c = *this;
+    uint64_t l = scalar::bitLength(s);
+    if(l == 0)
+    {
+        return z;
+    }
+    if((s[0] & 1) == 1)
+    {
+        z = *this;
+    }
+    for(uint64_t i = 1; i < l; i++)
+    {
+        c.cyclotomicSquareCompressedAssign();
+        if((s[i/64] >> (i%64) & 1) == 1)
+        {
+            powers.push_back(c);
+        }
+    }
+    fp12::batchDecompressKarabina(powers);
+    for(const fp12& p : powers)
+    {
+        z.multiplyAssign(p);
+    }
+    return z;
+}
+
 template<size_t N>
 g1 g1::scale(const std::array<uint64_t, N>& s) const
 {
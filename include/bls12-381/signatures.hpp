@@ -4,6 +4,7 @@
 #include <span>
 #include <vector>
 #include <string>
+#include <optional>
 #include <bls12-381/g.hpp>
 #include <bls12-381/fp.hpp>
 
@@ -14,6 +15,35 @@ class g2;
 
 extern const std::string CIPHERSUITE_ID;
 extern const std::string POP_CIPHERSUITE_ID;
+// minimal-signature-size variant: public keys in G2, signatures in G1
+extern const std::string CIPHERSUITE_ID_G1;
+extern const std::string POP_CIPHERSUITE_ID_G1;
+
+// Public keys (or other points) that passed the on-curve and subgroup checks. They can only be created
+// through 'validate', so the verify overloads taking them skip those checks. The point is stored in
+// affine form, ready for pairing.
+class validated_g1
+{
+public:
+    static std::optional<validated_g1> validate(const g1& p);
+    const g1& point() const;
+
+private:
+    friend class pubkey_registry;                       // keys from a file stamped as validated
+    explicit validated_g1(const g1& p);
+    g1 m_point;
+};
+
+class validated_g2
+{
+public:
+    static std::optional<validated_g2> validate(const g2& p);
+    const g2& point() const;
+
+private:
+    explicit validated_g2(const g2& p);
+    g2 m_point;
+};
 
 // Used to generate a domain separated extended sha256 hash used in 'map to curve'
 int xmd_sh256(
@@ -25,6 +55,41 @@ int xmd_sh256(
     int dst_len
 );
 
+// Expands every message of 'msgs' to 'buf_len' bytes (written to buf + i * buf_len), the
+// independent hashes of all messages are computed together
+int xmd_sh256(
+    uint8_t *buf,
+    int buf_len,
+    std::span<const std::span<const uint8_t>> msgs,
+    const uint8_t *dst,
+    int dst_len
+);
+
+// expand_message_xmd with SHA-256 for a fixed DST. The hash state after the constant Z_pad block
+// and the padded DST suffix of the b_i blocks are prepared once, at construction.
+class xmd_expander
+{
+public:
+    explicit xmd_expander(const std::string& dst);
+    // same result as xmd_sh256(buf, buf_len, msg.data(), msg.size(), dst, dst_len)
+    int expand(uint8_t* buf, int buf_len, std::span<const uint8_t> msg) const;
+    // same result as xmd_sh256(buf, buf_len, msgs, dst, dst_len): the messages are expanded in lockstep, each
+    // b_0 hash resuming from the cached state
+    int expand(uint8_t* buf, int buf_len, std::span<const std::span<const uint8_t>> msgs) const;
+    const std::string& dst() const;
+
+private:
+    std::string m_dst;
+    std::array<uint32_t, 8> m_midstate;
+    std::array<uint8_t, 5 * 64> m_suffix;
+    size_t m_suffixBlocks;
+};
+
+extern const xmd_expander CIPHERSUITE_XMD;
+extern const xmd_expander POP_CIPHERSUITE_XMD;
+extern const xmd_expander CIPHERSUITE_XMD_G1;
+extern const xmd_expander POP_CIPHERSUITE_XMD_G1;
+
 // Implements HMAC based on SHA256 as specified in RFC 2104: https://www.rfc-editor.org/rfc/rfc2104
 int hkdf256_hmac(
     uint8_t *mac,
@@ -107,11 +172,37 @@ std::array<uint64_t, 4> secret_key(std::span<const uint8_t> seed);
 // Derive public key from a BLS private key
 g1 public_key(const std::array<uint64_t, 4>& sk);
 
+// Derive a G2 public key from a BLS private key (minimal-signature-size variant)
+g2 public_key_g2(const std::array<uint64_t, 4>& sk);
+
 g2 fromMessage(
     std::span<const uint8_t> msg,
     const std::string& dst
 );
 
+g2 fromMessage(
+    std::span<const uint8_t> msg,
+    const xmd_expander& xmd
+);
+
+g1 fromMessageG1(
+    std::span<const uint8_t> msg,
+    const std::string& dst
+);
+
+g1 fromMessageG1(
+    std::span<const uint8_t> msg,
+    const xmd_expander& xmd
+);
+
+// Hashes many messages to G2 at once: the message expansions are batched and the work is spread
+// over up to 'threads' threads. Each result equals fromMessage(msgs[i], dst).
+std::vector<g2> fromMessages(
+    std::span<const std::span<const uint8_t>> msgs,
+    const std::string& dst,
+    size_t threads = 1
+);
+
 // Sign message with a private key
 g2 sign(
     const std::array<uint64_t, 4>& sk,
@@ -125,11 +216,18 @@ bool verify(
     const g2& signature
 );
 
+bool verify(
+    const validated_g1& pubkey,
+    std::span<const uint8_t> message,
+    const g2& signature
+);
+
 // Aggregate private keys
 std::array<uint64_t, 4> aggregate_secret_keys(std::span<const std::array<uint64_t, 4>> sks);
 
 // Aggregate public keys
 g1 aggregate_public_keys(std::span<const g1> pks);
+g1 aggregate_public_keys(std::span<const g1_affine> pks);
 
 // Aggregate signatures
 g2 aggregate_signatures(std::span<const g2> sigs);
@@ -138,11 +236,53 @@ g2 aggregate_signatures(std::span<const g2> sigs);
 // the boolean parameter enables an additional check for duplicate messages (possible attack
 // vector: see page 6 of https://crypto.stanford.edu/~dabo/pubs/papers/aggreg.pdf, "A potential
 // attack on aggregate signatures.")
+// The public key checks, the message hashing and the Miller loops are spread over up to 'threads' threads.
 bool aggregate_verify(
     std::span<const g1> pubkeys,
     std::span<const std::vector<uint8_t>> messages,
     const g2& signature,
-    const bool checkForDuplicateMessages = false
+    const bool checkForDuplicateMessages = false,
+    size_t threads = 1
+);
+
+bool aggregate_verify(
+    std::span<const validated_g1> pubkeys,
+    std::span<const std::vector<uint8_t>> messages,
+    const g2& signature,
+    const bool checkForDuplicateMessages = false,
+    size_t threads = 1
+);
+
+// Verifies n independent signatures (pubkeys[i], messages[i], signatures[i]) at once with a single
+// (n + 1)-pair multi-pairing over random linear combinations. Returns true only if all of them are
+// valid (up to a 2^-64 probability of accepting an invalid batch), false for empty or mismatched input.
+bool batch_verify(
+    std::span<const g1> pubkeys,
+    std::span<const std::span<const uint8_t>> messages,
+    std::span<const g2> signatures
+);
+
+// Same as batch_verify, but when the batch fails it is bisected to find the culprits: each split pairs only
+// its left half again and derives the right half from the parent result, reusing hashes and weights.
+// Returns the sorted indices of the invalid signatures (empty if all are valid) or std::nullopt if the
+// input spans differ in length.
+std::optional<std::vector<size_t>> batch_verify_find_invalid(
+    std::span<const g1> pubkeys,
+    std::span<const std::span<const uint8_t>> messages,
+    std::span<const g2> signatures
+);
+
+// Same as above for keys and signatures stored in compact affine form, the subgroup checks still apply
+bool batch_verify(
+    std::span<const g1_affine> pubkeys,
+    std::span<const std::span<const uint8_t>> messages,
+    std::span<const g2_affine> signatures
+);
+
+std::optional<std::vector<size_t>> batch_verify_find_invalid(
+    std::span<const g1_affine> pubkeys,
+    std::span<const std::span<const uint8_t>> messages,
+    std::span<const g2_affine> signatures
 );
 
 // `f` is an accessor function in case we have a span of objects of type T containing public keys: `g1 f(const T&)`
@@ -186,10 +326,82 @@ bool pop_verify(
     const g2& signature_proof
 );
 
+bool pop_verify(
+    const validated_g1& pubkey,
+    const g2& signature_proof
+);
+
 bool pop_fast_aggregate_verify(
     std::span<const g1> pubkeys,
     std::span<const uint8_t> message,
     const g2& signature
 );
 
+bool pop_fast_aggregate_verify(
+    std::span<const validated_g1> pubkeys,
+    std::span<const uint8_t> message,
+    const g2& signature
+);
+
+// Minimal-signature-size variant of the functions above: public keys in G2, 48 byte signatures in G1
+g1 sign_g1(
+    const std::array<uint64_t, 4>& sk,
+    std::span<const uint8_t> msg
+);
+
+bool verify_g1(
+    const g2& pubkey,
+    std::span<const uint8_t> message,
+    const g1& signature
+);
+
+bool verify_g1(
+    const validated_g2& pubkey,
+    std::span<const uint8_t> message,
+    const g1& signature
+);
+
+g2 aggregate_public_keys_g2(std::span<const g2> pks);
+g2 aggregate_public_keys_g2(std::span<const g2_affine> pks);
+
+g1 aggregate_signatures_g1(std::span<const g1> sigs);
+
+bool aggregate_verify_g1(
+    std::span<const g2> pubkeys,
+    std::span<const std::vector<uint8_t>> messages,
+    const g1& signature,
+    const bool checkForDuplicateMessages = false
+);
+
+bool aggregate_verify_g1(
+    std::span<const validated_g2> pubkeys,
+    std::span<const std::vector<uint8_t>> messages,
+    const g1& signature,
+    const bool checkForDuplicateMessages = false
+);
+
+g1 pop_prove_g1(const std::array<uint64_t, 4>& sk);
+
+bool pop_verify_g1(
+    const g2& pubkey,
+    const g1& signature_proof
+);
+
+bool pop_verify_g1(
+    const validated_g2& pubkey,
+    const g1& signature_proof
+);
+
+bool pop_fast_aggregate_verify_g1(
+    std::span<const g2> pubkeys,
+    std::span<const uint8_t> message,
+    const g1& signature
+);
+
+bool pop_fast_aggregate_verify_g1(
+    std::span<const validated_g2> pubkeys,
+    std::span<const uint8_t> message,
+    const g1& signature
+);
+
 } // namespace bls12_381
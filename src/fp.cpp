@@ -1068,6 +1068,25 @@ fp6 fp6::mulBy1(const fp2& e1) const
     return c;
 }
 
+fp6 fp6::mulBy12(const fp2& e1, const fp2& e2) const
+{
+    fp2 t[4];
+    fp6 c;
+    t[0] = c1.multiply(e1);
+    t[1] = c2.multiply(e2);
+    t[2] = c1.add(c2);
+    t[3] = e1.add(e2);
+    t[2].multiplyAssign(t[3]);
+    t[2].subtractAssign(t[0]);
+    t[2].subtractAssign(t[1]);
+    c.c0 = t[2].mulByNonResidue();
+    c.c1 = c0.multiply(e1);
+    c.c1.addAssign(t[1].mulByNonResidue());
+    c.c2 = c0.multiply(e2);
+    c.c2.addAssign(t[0]);
+    return c;
+}
+
 fp6 fp6::mulByNonResidue() const
 {
     fp6 c;
@@ -1280,6 +1299,133 @@ array<uint8_t, 576> fp12::toBytesLE(const from_mont fm /* = from_mont::yes */) c
     return out;
 }
 
+// T2 torus compression (https://eprint.iacr.org/2004/032.pdf): an element g0 + g1 * w of the cyclotomic
+// subgroup is represented by c = (1 + g0) / g1, so that g = (c + w) / (c - w). The identity has no such
+// representation and is encoded with the 0x40 flag set in the most significant byte.
+static fp6 torusCompress(const fp12& e)
+{
+    fp6 c = e.c0.add(fp6::one());
+    return c.multiply(e.c1.inverse());
+}
+
+// g0 = (c^2 + v) / (c^2 - v), g1 = 2 * c / (c^2 - v), 'd' holds the inverse of c^2 - v
+static fp12 torusDecompress(const fp6& c, const fp6& d)
+{
+    fp12 e;
+    fp6 t = c.square();
+    t.c1.addAssign(fp2::one());
+    e.c0 = t.multiply(d);
+    e.c1 = c.dbl().multiply(d);
+    return e;
+}
+
+static fp6 torusDenominator(const fp6& c)
+{
+    fp6 t = c.square();
+    t.c1.subtractAssign(fp2::one());
+    return t;
+}
+
+static optional<fp6> torusFromBytes(const span<const uint8_t, 288> in, const size_t msb, bool& identity, const conv_opt opt, bool be)
+{
+    array<uint8_t, 288> buf;
+    memcpy(buf.data(), in.data(), 288);
+    identity = (buf[msb] & 0x40) != 0;
+    if(opt.check_valid && (buf[msb] & 0xA0) != 0) return {};
+    buf[msb] &= 0x1F;
+    optional<fp6> c = be ? fp6::fromBytesBE(buf, opt) : fp6::fromBytesLE(buf, opt);
+    if(!c) return {};
+    if(identity && opt.check_valid && !c->isZero()) return {};
+    return c;
+}
+
+optional<fp12> fp12::fromCompressedBytesBE(const span<const uint8_t, 288> in, const conv_opt opt)
+{
+    bool identity;
+    optional<fp6> c = torusFromBytes(in, 0, identity, opt, true);
+    if(!c) return {};
+    if(identity) return fp12::one();
+    return torusDecompress(*c, torusDenominator(*c).inverse());
+}
+
+optional<fp12> fp12::fromCompressedBytesLE(const span<const uint8_t, 288> in, const conv_opt opt)
+{
+    bool identity;
+    optional<fp6> c = torusFromBytes(in, 287, identity, opt, false);
+    if(!c) return {};
+    if(identity) return fp12::one();
+    return torusDecompress(*c, torusDenominator(*c).inverse());
+}
+
+static optional<vector<fp12>> torusFromBytes(const span<const array<uint8_t, 288>> in, const conv_opt opt, bool be)
+{
+    // all denominators are inverted at once
+    vector<fp6> c(in.size()), d(in.size());
+    vector<bool> identity(in.size());
+    for(size_t i = 0; i < in.size(); i++)
+    {
+        bool id;
+        optional<fp6> t = torusFromBytes(in[i], be ? 0 : 287, id, opt, be);
+        if(!t) return {};
+        c[i] = *t;
+        identity[i] = id;
+        d[i] = id ? fp6::one() : torusDenominator(c[i]);
+    }
+    batchInverse<fp6>(d);
+    vector<fp12> out(in.size());
+    for(size_t i = 0; i < in.size(); i++)
+    {
+        out[i] = identity[i] ? fp12::one() : torusDecompress(c[i], d[i]);
+    }
+    return out;
+}
+
+optional<vector<fp12>> fp12::fromCompressedBytesBE(const span<const array<uint8_t, 288>> in, const conv_opt opt)
+{
+    return torusFromBytes(in, opt, true);
+}
+
+optional<vector<fp12>> fp12::fromCompressedBytesLE(const span<const array<uint8_t, 288>> in, const conv_opt opt)
+{
+    return torusFromBytes(in, opt, false);
+}
+
+void fp12::toCompressedBytesBE(const span<uint8_t, 288> out, const from_mont fm /* = from_mont::yes */) const
+{
+    if(isOne())
+    {
+        memset(out.data(), 0, 288);
+        out[0] = 0x40;
+        return;
+    }
+    torusCompress(*this).toBytesBE(out, fm);
+}
+
+void fp12::toCompressedBytesLE(const span<uint8_t, 288> out, const from_mont fm /* = from_mont::yes */) const
+{
+    if(isOne())
+    {
+        memset(out.data(), 0, 288);
+        out[287] = 0x40;
+        return;
+    }
+    torusCompress(*this).toBytesLE(out, fm);
+}
+
+array<uint8_t, 288> fp12::toCompressedBytesBE(const from_mont fm /* = from_mont::yes */) const
+{
+    array<uint8_t, 288> out;
+    toCompressedBytesBE(out, fm);
+    return out;
+}
+
+array<uint8_t, 288> fp12::toCompressedBytesLE(const from_mont fm /* = from_mont::yes */) const
+{
+    array<uint8_t, 288> out;
+    toCompressedBytesLE(out, fm);
+    return out;
+}
+
 fp12 fp12::zero()
 {
     return fp12({fp6::zero(), fp6::zero()});
@@ -1303,7 +1449,19 @@ bool fp12::isZero() const
 // IsValid checks whether given target group element is in correct subgroup.
 bool fp12::isGtValid() const
 {
-    return this->exp(fp::Q).isOne();
+    // https://eprint.iacr.org/2021/1130.pdf, section 6: an element is in GT if it is in the
+    // cyclotomic subgroup (g^(p^4 - p^2 + 1) == 1) and g^p == g^x
+    if(isZero())
+    {
+        return false;
+    }
+    fp12 t = frobeniusMap(4);
+    t.multiplyAssign(*this);
+    if(!t.equal(frobeniusMap(2)))
+    {
+        return false;
+    }
+    return cyclotomicExpByX().equal(frobeniusMap(1));
 }
 
 bool fp12::equal(const fp12& e) const
@@ -1417,6 +1575,153 @@ void fp12::cyclotomicSquareAssign() {
     c0.c2 = t[2].add(t[5]);
 }
 
+fp12 fp12::cyclotomicSquareCompressed() const
+{
+    fp12 c(*this);
+    c.cyclotomicSquareCompressedAssign();
+    return c;
+}
+
+fp12 fp12::cyclotomicExpByX() const
+{
+    // cyclotomicExpCompressed over the compile-time digits of |x| = 0xd201000000010000: the compressed powers at the
+    // non-zero digits are decompressed together into a fixed buffer. x is negative and the inverse of a cyclotomic
+    // element is its conjugate.
+    using chain = scalar::digitChain<0xd201000000010000>;
+    array<fp12, chain::weight> powers;
+    array<bool, chain::weight> negative;
+    size_t k = 0;
+    fp12 c = *this;
+    for(size_t i = 0; i < chain::length; i++)
+    {
+        if(i > 0)
+        {
+            c.cyclotomicSquareCompressedAssign();
+        }
+        if(chain::digits[i] != 0)
+        {
+            powers[k] = c;
+            negative[k++] = chain::digits[i] < 0;
+        }
+    }
+    // |x| is even, so the lowest power is never the uncompressed input
+    static_assert(chain::digits[0] == 0);
+    batchDecompressKarabina(powers);
+    fp12 z = negative[0] ? powers[0].conjugate() : powers[0];
+    for(size_t i = 1; i < k; i++)
+    {
+        z.multiplyAssign(negative[i] ? powers[i].conjugate() : powers[i]);
+    }
+    return z.conjugate();
+}
+
+void fp12::cyclotomicSquareCompressedAssign()
+{
+    // Karabina's compressed squaring (https://eprint.iacr.org/2010/542.pdf), only
+    // g1 = c0.c1, g2 = c0.c2, g3 = c1.c0 and g5 = c1.c2 are tracked
+    fp2 t[7];
+    t[0] = c0.c1.square();
+    t[1] = c1.c2.square();
+    t[5] = c0.c1.add(c1.c2);
+    t[2] = t[5].square();
+    t[3] = t[0].add(t[1]);
+    t[5] = t[2].subtract(t[3]);
+    t[6] = c1.c0.add(c0.c2);
+    t[3] = t[6].square();
+    t[2] = c1.c0.square();
+    t[6] = t[5].mulByNonResidue();
+    t[5] = t[6].add(c1.c0);
+    t[5].doubleAssign();
+    c1.c0 = t[5].add(t[6]);
+    t[4] = t[1].mulByNonResidue();
+    t[5] = t[0].add(t[4]);
+    t[6] = t[5].subtract(c0.c2);
+    t[1] = c0.c2.square();
+    t[6].doubleAssign();
+    c0.c2 = t[6].add(t[5]);
+    t[4] = t[1].mulByNonResidue();
+    t[5] = t[2].add(t[4]);
+    t[6] = t[5].subtract(c0.c1);
+    t[6].doubleAssign();
+    c0.c1 = t[6].add(t[5]);
+    t[0] = t[2].add(t[1]);
+    t[5] = t[3].subtract(t[0]);
+    t[6] = t[5].add(c1.c2);
+    t[6].doubleAssign();
+    c1.c2 = t[5].add(t[6]);
+}
+
+// numerator and denominator of the g4 = c1.c1 coefficient of a compressed element
+static tuple<fp2, fp2> karabinaG4(const fp12& e)
+{
+    fp2 t[3];
+    if(e.c1.c0.isZero())
+    {
+        // g4 = 2 * g1 * g5 / g2
+        t[0] = e.c0.c1.multiply(e.c1.c2);
+        t[0].doubleAssign();
+        t[1] = e.c0.c2;
+    }
+    else
+    {
+        // g4 = (nr * g5^2 + 3 * g1^2 - 2 * g2) / (4 * g3)
+        t[0] = e.c0.c1.square();
+        t[1] = t[0].subtract(e.c0.c2);
+        t[1].doubleAssign();
+        t[1].addAssign(t[0]);
+        t[2] = e.c1.c2.square();
+        t[0] = t[2].mulByNonResidue();
+        t[0].addAssign(t[1]);
+        t[1] = e.c1.c0.dbl();
+        t[1].doubleAssign();
+    }
+    return {t[0], t[1]};
+}
+
+// recovers g0 = c0.c0 once g4 is known
+static void karabinaG0(fp12& e)
+{
+    fp2 t[2];
+    // g0 = nr * (2 * g4^2 + g3 * g5 - 3 * g2 * g1) + 1
+    t[0] = e.c0.c2.multiply(e.c0.c1);
+    t[1] = e.c1.c1.square();
+    t[1].subtractAssign(t[0]);
+    t[1].doubleAssign();
+    t[1].subtractAssign(t[0]);
+    t[0] = e.c1.c0.multiply(e.c1.c2);
+    t[1].addAssign(t[0]);
+    e.c0.c0 = t[1].mulByNonResidue();
+    e.c0.c0.addAssign(fp2::one());
+}
+
+fp12 fp12::decompressKarabina() const
+{
+    fp12 c(*this);
+    batchDecompressKarabina(span<fp12>(&c, 1));
+    return c;
+}
+
+void fp12::batchDecompressKarabina(span<fp12> e)
+{
+    vector<fp2> num(e.size()), den(e.size());
+    for(size_t i = 0; i < e.size(); i++)
+    {
+        tie(num[i], den[i]) = karabinaG4(e[i]);
+    }
+    batchInverse<fp2>(den);
+    for(size_t i = 0; i < e.size(); i++)
+    {
+        if(den[i].isZero())
+        {
+            // g2 = g3 = 0 only happens for the identity
+            e[i] = fp12::one();
+            continue;
+        }
+        e[i].c1.c1 = num[i].multiply(den[i]);
+        karabinaG0(e[i]);
+    }
+}
+
 fp12 fp12::multiply(const fp12& e) const
 {
     fp12 c(*this);
@@ -1484,6 +1789,51 @@ void fp12::mulBy014Assign(const fp2& e0, const fp2& e1, const fp2& e4)
     c0 = t[1].add(t[0]);
 }
 
+// multiplies two sparse line evaluations (e0 + e1 * v) + e4 * v * w and (d0 + d1 * v) + d4 * v * w,
+// the result has a zero c1.c0 coefficient and can be folded in using mulBy01245Assign
+fp12 fp12::mul014By014(const fp2& e0, const fp2& e1, const fp2& e4, const fp2& d0, const fp2& d1, const fp2& d4)
+{
+    fp2 t[5];
+    fp12 c;
+    t[0] = e0.multiply(d0);
+    t[1] = e1.multiply(d1);
+    t[2] = e4.multiply(d4);
+    t[3] = e0.add(e1);
+    t[4] = d0.add(d1);
+    t[3].multiplyAssign(t[4]);
+    t[3].subtractAssign(t[0]);
+    c.c0.c1 = t[3].subtract(t[1]);
+    t[3] = e0.add(e4);
+    t[4] = d0.add(d4);
+    t[3].multiplyAssign(t[4]);
+    t[3].subtractAssign(t[0]);
+    c.c1.c1 = t[3].subtract(t[2]);
+    t[3] = e1.add(e4);
+    t[4] = d1.add(d4);
+    t[3].multiplyAssign(t[4]);
+    t[3].subtractAssign(t[1]);
+    c.c1.c2 = t[3].subtract(t[2]);
+    c.c0.c0 = t[2].mulByNonResidue();
+    c.c0.c0.addAssign(t[0]);
+    c.c0.c2 = t[1];
+    c.c1.c0 = fp2::zero();
+    return c;
+}
+
+// multiplies by an element whose c1.c0 coefficient is zero (the output of mul014By014)
+void fp12::mulBy01245Assign(const fp12& e)
+{
+    fp6 t[3];
+    t[0] = c0.multiply(e.c0);
+    t[1] = c1.mulBy12(e.c1.c1, e.c1.c2);
+    t[2] = c0.add(c1);
+    c1 = t[2].multiply(e.c0.add(e.c1));
+    c1.subtractAssign(t[0]);
+    c1.subtractAssign(t[1]);
+    c0 = t[1].mulByNonResidue();
+    c0.addAssign(t[0]);
+}
+
 fp12 fp12::frobeniusMap(const uint64_t& power) const
 {
     fp12 c;
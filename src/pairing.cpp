@@ -95,11 +95,38 @@ void pre_compute(array<array<fp2, 3>, 68>& ellCoeffs, const g2& twistPoint)
 
 fp12 miller_loop(std::span<const std::tuple<g1, g2>> pairs, std::function<void()> yield)
 {
-    vector<array<array<fp2, 3>, 68>> ellCoeffs;
-    ellCoeffs.resize(pairs.size());
-    for(uint64_t i = 0; i < pairs.size(); i++)
+    // The line coefficients are stored step-major: all pairs of step k are contiguous, so the
+    // Miller loop below walks through the table linearly instead of striding across one
+    // 68 step block per pair.
+    const uint64_t n = pairs.size();
+    vector<array<fp2, 3>> ellCoeffs(68 * n);
+    vector<g2> r(n);
+    for(uint64_t j = 0; j < n; j++)
     {
-        pre_compute(ellCoeffs[i], get<g2>(pairs[i]));
+        r[j] = get<g2>(pairs[j]);
+    }
+    int64_t k = 0;
+    for(int64_t i = 64 - 2; i >= 0; i--)
+    {
+        for(uint64_t j = 0; j < n; j++)
+        {
+            if(!get<g2>(pairs[j]).isZero())
+            {
+                doubling_step(ellCoeffs[k*n + j], r[j]);
+            }
+        }
+        if(((g2::cofactorEFF[0] >> i) & 1) == 1)
+        {
+            k++;
+            for(uint64_t j = 0; j < n; j++)
+            {
+                if(!get<g2>(pairs[j]).isZero())
+                {
+                    addition_step(ellCoeffs[k*n + j], r[j], get<g2>(pairs[j]));
+                }
+            }
+        }
+        k++;
     }
     if(pairs.size() >= 20 && yield)
     {
@@ -107,28 +134,51 @@ fp12 miller_loop(std::span<const std::tuple<g1, g2>> pairs, std::function<void()
     }
     fp2 t[10];
     fp12 f = fp12::one();
-    int64_t k = 0;
+    k = 0;
+    auto mulByLines = [&](size_t step)
+    {
+        const array<fp2, 3>* ell = &ellCoeffs[step*n];
+        // entries left in the table from 'ell' on, the prefetches must not form addresses beyond it
+        const size_t avail = ellCoeffs.size() - step*n;
+        // lines of two pairs are first multiplied with each other, which is cheaper than
+        // folding each of them into the dense accumulator separately
+        uint64_t j = 0;
+        for(; j + 1 < n; j += 2)
+        {
+            // fetch the coefficients a few pairs ahead (spilling into the next step at the end)
+            if(j + 5 < avail)
+            {
+                __builtin_prefetch(&ell[j + 4]);
+                __builtin_prefetch(reinterpret_cast<const uint8_t*>(&ell[j + 4]) + 128);
+                __builtin_prefetch(reinterpret_cast<const uint8_t*>(&ell[j + 4]) + 256);
+                __builtin_prefetch(&ell[j + 5]);
+                __builtin_prefetch(reinterpret_cast<const uint8_t*>(&ell[j + 5]) + 128);
+                __builtin_prefetch(reinterpret_cast<const uint8_t*>(&ell[j + 5]) + 256);
+            }
+            t[0] = ell[j][2].mulByFq(get<g1>(pairs[j]).y);
+            t[1] = ell[j][1].mulByFq(get<g1>(pairs[j]).x);
+            t[2] = ell[j + 1][2].mulByFq(get<g1>(pairs[j + 1]).y);
+            t[3] = ell[j + 1][1].mulByFq(get<g1>(pairs[j + 1]).x);
+            f.mulBy01245Assign(fp12::mul014By014(ell[j][0], t[1], t[0], ell[j + 1][0], t[3], t[2]));
+        }
+        if(j < n)
+        {
+            t[0] = ell[j][2].mulByFq(get<g1>(pairs[j]).y);
+            t[1] = ell[j][1].mulByFq(get<g1>(pairs[j]).x);
+            f.mulBy014Assign(ell[j][0], t[1], t[0]);
+        }
+    };
     for(int64_t i = 64 - 2; i >= 0; i--)
     {
         if(i != 64 - 2)
         {
             f = f.square();
         }
-        for(uint64_t j = 0; j <= pairs.size()-1; j++)
-        {
-            t[0] = ellCoeffs[j][k][2].mulByFq(get<g1>(pairs[j]).y);
-            t[1] = ellCoeffs[j][k][1].mulByFq(get<g1>(pairs[j]).x);
-            f.mulBy014Assign(ellCoeffs[j][k][0], t[1], t[0]);
-        }
+        mulByLines(k);
         if(((g2::cofactorEFF[0] >> i) & 1) == 1)
         {
             k++;
-            for(uint64_t j = 0; j <= pairs.size()-1; j++)
-            {
-                t[0] = ellCoeffs[j][k][2].mulByFq(get<g1>(pairs[j]).y);
-                t[1] = ellCoeffs[j][k][1].mulByFq(get<g1>(pairs[j]).x);
-                f.mulBy014Assign(ellCoeffs[j][k][0], t[1], t[0]);
-            }
+            mulByLines(k);
         }
         k++;
     }
@@ -149,19 +199,14 @@ void final_exponentiation(fp12& f)
     t[1] = t[2].cyclotomicSquare();
     t[1] = t[1].conjugate();
     // hard part
-    t[3] = t[2].cyclotomicExp(g2::cofactorEFF);
-    t[3] = t[3].conjugate();
+    t[3] = t[2].cyclotomicExpByX();
     t[4] = t[3].cyclotomicSquare();
     t[5] = t[1].multiply(t[3]);
-    t[1] = t[5].cyclotomicExp(g2::cofactorEFF);
-    t[1] = t[1].conjugate();
-    t[0] = t[1].cyclotomicExp(g2::cofactorEFF);
-    t[0] = t[0].conjugate();
-    t[6] = t[0].cyclotomicExp(g2::cofactorEFF);
-    t[6] = t[6].conjugate();
+    t[1] = t[5].cyclotomicExpByX();
+    t[0] = t[1].cyclotomicExpByX();
+    t[6] = t[0].cyclotomicExpByX();
     t[6].multiplyAssign(t[4]);
-    t[4] = t[6].cyclotomicExp(g2::cofactorEFF);
-    t[4] = t[4].conjugate();
+    t[4] = t[6].cyclotomicExpByX();
     t[5] = t[5].conjugate();
     t[4].multiplyAssign(t[5]);
     t[4].multiplyAssign(t[2]);
@@ -189,6 +234,17 @@ fp12 calculate(std::span<const std::tuple<g1, g2>> pairs, std::function<void()>
     return f;
 }
 
+fp12 calculate(std::span<const std::tuple<g1_affine, g2_affine>> pairs, std::function<void()> yield)
+{
+    vector<tuple<g1, g2>> v;
+    v.reserve(pairs.size());
+    for(const auto& [e1, e2] : pairs)
+    {
+        add_pair(v, e1, e2);
+    }
+    return calculate(v, yield);
+}
+
 void add_pair(vector<tuple<g1, g2>>& pairs, const g1& e1, const g2& e2)
 {
     if(!(e1.isZero() || e2.isZero()))
@@ -197,5 +253,14 @@ void add_pair(vector<tuple<g1, g2>>& pairs, const g1& e1, const g2& e2)
     }
 }
 
+void add_pair(vector<tuple<g1, g2>>& pairs, const g1_affine& e1, const g2_affine& e2)
+{
+    // already affine, no inversions
+    if(!(e1.isZero() || e2.isZero()))
+    {
+        pairs.emplace_back(e1.toJacobian(), e2.toJacobian());
+    }
+}
+
 } // namespace pairing
 } // namespace bls12_381
@@ -0,0 +1,39 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <thread>
+#include <vector>
+
+namespace bls12_381
+{
+
+// Splits [0, n) into at most 'threads' contiguous ranges and runs f(begin, end) for each of them.
+// The first range is processed on the calling thread.
+template<typename F>
+void parallel_for(size_t n, size_t threads, F&& f)
+{
+    threads = std::max<size_t>(1, std::min(threads, n));
+    if(threads == 1)
+    {
+        if(n > 0)
+        {
+            f(size_t(0), n);
+        }
+        return;
+    }
+    std::vector<std::thread> workers;
+    workers.reserve(threads - 1);
+    const size_t chunk = (n + threads - 1) / threads;
+    for(size_t begin = chunk; begin < n; begin += chunk)
+    {
+        workers.emplace_back([&f, begin, end = std::min(n, begin + chunk)]() { f(begin, end); });
+    }
+    f(size_t(0), std::min(n, chunk));
+    for(std::thread& t : workers)
+    {
+        t.join();
+    }
+}
+
+} // namespace bls12_381
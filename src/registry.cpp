@@ -0,0 +1,259 @@
+#include <bls12-381/bls12-381.hpp>
+#include "sha256.hpp"
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+
+// The records are handed out in place where files can be mapped and the little endian records have the memory
+// layout of g1_affine. Everywhere else they are read and converted into memory.
+#if (defined(__unix__) || defined(__APPLE__)) && defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+#define BLS_REGISTRY_MMAP
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+using namespace std;
+
+namespace bls12_381
+{
+
+static const char registryMagic[8] = {'B', 'L', 'S', '1', 'P', 'K', 'R', 'G'};
+static const uint32_t registryVersion = 1;
+static const uint32_t registryValidated = 1;
+static const size_t registryHeaderSize = 64;
+// the checksum at offset 24 covers the header bytes before it and the key records
+static const size_t registryChecksummed = 24;
+static const size_t registryRecordSize = 96;
+
+#ifdef BLS_REGISTRY_MMAP
+static_assert(sizeof(g1_affine) == registryRecordSize && alignof(g1_affine) <= 64);
+#endif
+
+static uint64_t loadLE(const uint8_t* p, size_t n)
+{
+    uint64_t v = 0;
+    for(size_t i = n; i-- > 0;)
+    {
+        v = (v << 8) | p[i];
+    }
+    return v;
+}
+
+static void storeLE(uint8_t* p, uint64_t v, size_t n)
+{
+    for(size_t i = 0; i < n; i++, v >>= 8)
+    {
+        p[i] = static_cast<uint8_t>(v);
+    }
+}
+
+// the number of keys if the header, the size and, if requested, the checksum of the file in 'data' are valid
+static optional<size_t> checkRegistry(const uint8_t* data, size_t size, bool verifyChecksum)
+{
+    if(size < registryHeaderSize)
+    {
+        return nullopt;
+    }
+    const size_t records = size - registryHeaderSize;
+    if(memcmp(data, registryMagic, sizeof(registryMagic)) != 0 || loadLE(data + 8, 4) != registryVersion ||
+       (loadLE(data + 12, 4) & registryValidated) == 0 || loadLE(data + 16, 8) != records / registryRecordSize ||
+       records % registryRecordSize != 0)
+    {
+        return nullopt;
+    }
+    if(verifyChecksum)
+    {
+        sha256 sha;
+        sha.update(data, registryChecksummed);
+        sha.update(data + registryHeaderSize, records);
+        array<uint8_t, 32> checksum;
+        memcpy(checksum.data(), data + registryChecksummed, checksum.size());
+        if(sha.digest() != checksum)
+        {
+            return nullopt;
+        }
+    }
+    return records / registryRecordSize;
+}
+
+bool pubkey_registry::write(const string& path, span<const g1> keys)
+{
+    if(!all_of(keys.begin(), keys.end(), [](const g1& p) { return !p.isZero() && p.isOnCurve(); }) ||
+       !g1::batchInCorrectSubgroup(keys))
+    {
+        return false;
+    }
+
+    uint8_t h[registryHeaderSize] = {};
+    memcpy(h, registryMagic, sizeof(registryMagic));
+    storeLE(h + 8, registryVersion, 4);
+    storeLE(h + 12, registryValidated, 4);
+    storeLE(h + 16, keys.size(), 8);
+
+    vector<uint8_t> records(keys.size() * registryRecordSize);
+    g1::toAffineBytesLE(keys, records, from_mont::no);
+    sha256 sha;
+    sha.update(h, registryChecksummed);
+    sha.update(records.data(), records.size());
+    sha.digest(h + registryChecksummed);
+
+    ofstream out(path, ios::binary | ios::trunc);
+    out.write(reinterpret_cast<const char*>(h), sizeof(h));
+    out.write(reinterpret_cast<const char*>(records.data()), records.size());
+    out.close();
+    return !out.fail();
+}
+
+optional<pubkey_registry> pubkey_registry::open(const string& path)
+{
+    return open(path, true);
+}
+
+optional<pubkey_registry> pubkey_registry::openUnverified(const string& path)
+{
+    return open(path, false);
+}
+
+optional<pubkey_registry> pubkey_registry::open(const string& path, bool verifyChecksum)
+{
+#ifdef BLS_REGISTRY_MMAP
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if(fd < 0)
+    {
+        return nullopt;
+    }
+    struct stat st;
+    if(fstat(fd, &st) != 0 || static_cast<size_t>(st.st_size) < registryHeaderSize)
+    {
+        ::close(fd);
+        return nullopt;
+    }
+    const size_t mapped = st.st_size;
+    void* m = mmap(nullptr, mapped, PROT_READ, MAP_PRIVATE, fd, 0);
+    ::close(fd);
+    if(m == MAP_FAILED)
+    {
+        return nullopt;
+    }
+    // owns the mapping from here on, including the early return
+    pubkey_registry r(static_cast<const uint8_t*>(m), mapped, 0, verifyChecksum);
+    optional<size_t> count = checkRegistry(r.m_data, mapped, verifyChecksum);
+    if(!count)
+    {
+        return nullopt;
+    }
+    r.m_count = *count;
+    return r;
+#else
+    ifstream in(path, ios::binary);
+    if(!in)
+    {
+        return nullopt;
+    }
+    vector<uint8_t> file((istreambuf_iterator<char>(in)), istreambuf_iterator<char>());
+    optional<size_t> count = checkRegistry(file.data(), file.size(), verifyChecksum);
+    if(!count)
+    {
+        return nullopt;
+    }
+    pubkey_registry r(nullptr, 0, *count, verifyChecksum);
+    r.m_copy.resize(*count);
+    // like the mapped records, the raw values are handed out as they are
+    const conv_opt opt = {.check_valid = false, .to_mont = false};
+    for(size_t i = 0; i < *count; i++)
+    {
+        const uint8_t* record = file.data() + registryHeaderSize + i * registryRecordSize;
+        optional<fp> x = fp::fromBytesLE(span<const uint8_t, 48>(record, 48), opt);
+        optional<fp> y = fp::fromBytesLE(span<const uint8_t, 48>(record + 48, 48), opt);
+        if(!x || !y)
+        {
+            return nullopt;
+        }
+        r.m_copy[i] = g1_affine(*x, *y);
+    }
+    return r;
+#endif
+}
+
+pubkey_registry::pubkey_registry(const uint8_t* data, size_t mapped, size_t count, bool verified) : m_data(data), m_mapped(mapped), m_count(count), m_verified(verified)
+{
+}
+
+pubkey_registry::pubkey_registry(pubkey_registry&& other) noexcept : m_data(other.m_data), m_mapped(other.m_mapped), m_count(other.m_count), m_verified(other.m_verified), m_copy(std::move(other.m_copy))
+{
+    other.m_data = nullptr;
+    other.m_mapped = 0;
+    other.m_count = 0;
+}
+
+pubkey_registry& pubkey_registry::operator=(pubkey_registry&& other) noexcept
+{
+    if(this != &other)
+    {
+#ifdef BLS_REGISTRY_MMAP
+        if(m_data)
+        {
+            munmap(const_cast<uint8_t*>(m_data), m_mapped);
+        }
+#endif
+        m_data = other.m_data;
+        m_mapped = other.m_mapped;
+        m_count = other.m_count;
+        m_verified = other.m_verified;
+        m_copy = std::move(other.m_copy);
+        other.m_data = nullptr;
+        other.m_mapped = 0;
+        other.m_count = 0;
+    }
+    return *this;
+}
+
+pubkey_registry::~pubkey_registry()
+{
+#ifdef BLS_REGISTRY_MMAP
+    if(m_data)
+    {
+        munmap(const_cast<uint8_t*>(m_data), m_mapped);
+    }
+#endif
+}
+
+size_t pubkey_registry::size() const
+{
+    return m_count;
+}
+
+span<const g1_affine> pubkey_registry::keys() const
+{
+    if(!m_data)
+    {
+        return m_copy;
+    }
+    // the records start at offset 64 of a page aligned mapping
+    return span<const g1_affine>(reinterpret_cast<const g1_affine*>(m_data + registryHeaderSize), m_count);
+}
+
+const g1_affine& pubkey_registry::operator[](size_t i) const
+{
+    return keys()[i];
+}
+
+optional<validated_g1> pubkey_registry::validated(size_t i) const
+{
+    const g1_affine& k = keys()[i];
+    if(!m_verified)
+    {
+        // without the checksum the stamp says nothing about this record
+        if(!k.x.isValid() || !k.y.isValid() || k.isZero())
+        {
+            return nullopt;
+        }
+        return validated_g1::validate(k.toJacobian());
+    }
+    return validated_g1(k.toJacobian());
+}
+
+} // namespace bls12_381
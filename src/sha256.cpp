@@ -1,7 +1,14 @@
 #include "sha256.hpp"
 #include <cstring>
+#include <algorithm>
+#include <vector>
+#include <cstdlib>
 #include <sstream>
 #include <iomanip>
+#ifdef __x86_64__
+#include <cpuid.h>
+#include <immintrin.h>
+#endif
 
 namespace bls12_381
 {
@@ -18,20 +25,57 @@ sha256::sha256(): m_blocklen(0), m_bitlen(0)
     m_state[7] = 0x5be0cd19;
 }
 
+sha256::sha256(const array<uint32_t, 8>& state, uint64_t bytes): m_blocklen(0), m_bitlen(bytes * 8)
+{
+    memcpy(m_state, state.data(), sizeof(m_state));
+}
+
+array<uint32_t, 8> sha256::state() const
+{
+    array<uint32_t, 8> s;
+    memcpy(s.data(), m_state, sizeof(m_state));
+    return s;
+}
+
+void sha256::digestPadded(const uint8_t* data, size_t blocks, uint8_t* out)
+{
+    sha256 sha;
+    sha256_transform(sha.m_state, data, blocks);
+    array<uint8_t, 32>* phash = reinterpret_cast<array<uint8_t, 32>*>(out);
+    sha.revert(*phash);
+}
+
 void sha256::update(const uint8_t * data, size_t length)
 {
-    for(size_t i = 0 ; i < length ; i++)
+    // complete a partially filled block first
+    if(m_blocklen > 0)
     {
-        m_data[m_blocklen++] = data[i];
-        if (m_blocklen == 64)
+        size_t n = min<size_t>(64 - m_blocklen, length);
+        memcpy(m_data + m_blocklen, data, n);
+        m_blocklen += n;
+        data += n;
+        length -= n;
+        if(m_blocklen < 64)
         {
-            transform();
-
-            // End of the block
-            m_bitlen += 512;
-            m_blocklen = 0;
+            return;
         }
+        transform();
+        m_bitlen += 512;
+        m_blocklen = 0;
+    }
+
+    // full blocks are compressed straight from the input
+    size_t blocks = length / 64;
+    if(blocks > 0)
+    {
+        sha256_transform(m_state, data, blocks);
+        m_bitlen += 512 * blocks;
+        data += 64 * blocks;
+        length -= 64 * blocks;
     }
+
+    memcpy(m_data, data, length);
+    m_blocklen = length;
 }
 
 void sha256::update(const string &data)
@@ -83,54 +127,343 @@ uint32_t sha256::sig1(uint32_t x)
 }
 
 void sha256::transform()
+{
+    sha256_transform(m_state, m_data, 1);
+}
+
+void sha256::transformGeneric(uint32_t* s, const uint8_t* data, size_t blocks)
 {
     uint32_t maj, xorA, ch, xorE, sum, newA, newE, m[64];
     uint32_t state[8];
 
-    for(uint8_t i = 0, j = 0; i < 16; i++, j += 4)
+    for(; blocks > 0; blocks--, data += 64)
     {
-        // Split data in 32 bit blocks for the 16 first words
-        m[i] = (m_data[j] << 24) | (m_data[j + 1] << 16) | (m_data[j + 2] << 8) | (m_data[j + 3]);
+        for(uint8_t i = 0, j = 0; i < 16; i++, j += 4)
+        {
+            // Split data in 32 bit blocks for the 16 first words
+            m[i] = (data[j] << 24) | (data[j + 1] << 16) | (data[j + 2] << 8) | (data[j + 3]);
+        }
+
+        for(uint8_t k = 16 ; k < 64; k++)
+        {
+            // Remaining 48 blocks
+            m[k] = sha256::sig1(m[k - 2]) + m[k - 7] + sha256::sig0(m[k - 15]) + m[k - 16];
+        }
+
+        for(uint8_t i = 0 ; i < 8 ; i++)
+        {
+            state[i] = s[i];
+        }
+
+        for(uint8_t i = 0; i < 64; i++)
+        {
+            maj   = sha256::majority(state[0], state[1], state[2]);
+            xorA  = sha256::rotr(state[0], 2) ^ sha256::rotr(state[0], 13) ^ sha256::rotr(state[0], 22);
+
+            ch = choose(state[4], state[5], state[6]);
+
+            xorE  = sha256::rotr(state[4], 6) ^ sha256::rotr(state[4], 11) ^ sha256::rotr(state[4], 25);
+
+            sum  = m[i] + K[i] + state[7] + ch + xorE;
+            newA = xorA + maj + sum;
+            newE = state[3] + sum;
+
+            state[7] = state[6];
+            state[6] = state[5];
+            state[5] = state[4];
+            state[4] = newE;
+            state[3] = state[2];
+            state[2] = state[1];
+            state[1] = state[0];
+            state[0] = newA;
+        }
+
+        for(uint8_t i = 0 ; i < 8 ; i++)
+        {
+            s[i] += state[i];
+        }
     }
+}
 
-    for(uint8_t k = 16 ; k < 64; k++)
+#ifdef __x86_64__
+// Intel SHA extensions, see https://www.intel.com/content/www/us/en/developer/articles/technical/intel-sha-extensions.html
+__attribute__((target("sha,sse4.1")))
+void sha256::transformShaNi(uint32_t* s, const uint8_t* data, size_t blocks)
+{
+    const __m128i shuf = _mm_set_epi64x(0x0c0d0e0f08090a0bULL, 0x0405060700010203ULL);
+    __m128i state0, state1, tmp, msg, abef, cdgh;
+    __m128i w[4];
+
+    // the instructions expect the state as ABEF and CDGH
+    tmp    = _mm_loadu_si128(reinterpret_cast<const __m128i*>(&s[0]));
+    state1 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(&s[4]));
+    tmp    = _mm_shuffle_epi32(tmp, 0xB1);
+    state1 = _mm_shuffle_epi32(state1, 0x1B);
+    state0 = _mm_alignr_epi8(tmp, state1, 8);
+    state1 = _mm_blend_epi16(state1, tmp, 0xF0);
+
+    for(; blocks > 0; blocks--, data += 64)
     {
-        // Remaining 48 blocks
-        m[k] = sha256::sig1(m[k - 2]) + m[k - 7] + sha256::sig0(m[k - 15]) + m[k - 16];
+        abef = state0;
+        cdgh = state1;
+
+#pragma GCC unroll 16
+        for(int i = 0; i < 16; i++)
+        {
+            if(i < 4)
+            {
+                w[i] = _mm_shuffle_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i*>(data + 16 * i)), shuf);
+            }
+            else
+            {
+                // w[i] = msg2(msg1(w[i-4], w[i-3]) + (w[i-2]:w[i-1] >> 32), w[i-1])
+                tmp = _mm_sha256msg1_epu32(w[i % 4], w[(i + 1) % 4]);
+                tmp = _mm_add_epi32(tmp, _mm_alignr_epi8(w[(i + 3) % 4], w[(i + 2) % 4], 4));
+                w[i % 4] = _mm_sha256msg2_epu32(tmp, w[(i + 3) % 4]);
+            }
+            msg = _mm_add_epi32(w[i % 4], _mm_loadu_si128(reinterpret_cast<const __m128i*>(&K[4 * i])));
+            state1 = _mm_sha256rnds2_epu32(state1, state0, msg);
+            msg = _mm_shuffle_epi32(msg, 0x0E);
+            state0 = _mm_sha256rnds2_epu32(state0, state1, msg);
+        }
+
+        state0 = _mm_add_epi32(state0, abef);
+        state1 = _mm_add_epi32(state1, cdgh);
     }
 
-    for(uint8_t i = 0 ; i < 8 ; i++)
-    {
-        state[i] = m_state[i];
+    tmp    = _mm_shuffle_epi32(state0, 0x1B);
+    state1 = _mm_shuffle_epi32(state1, 0xB1);
+    state0 = _mm_blend_epi16(tmp, state1, 0xF0);
+    state1 = _mm_alignr_epi8(state1, tmp, 8);
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(&s[0]), state0);
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(&s[4]), state1);
+}
+
+typedef void (*sha256_transform_func_t)(uint32_t*, const uint8_t*, size_t);
+
+static bool cpu_has_sha() {
+    int32_t info[4];
+    __cpuid_count(0, 0, info[0], info[1], info[2], info[3]);
+    int nIds = info[0];
+    if(nIds >= 0x00000007) {
+        __cpuid_count(0x00000001, 0, info[0], info[1], info[2], info[3]);
+        if(!(info[2] & (1 << 19))) // SSE4.1
+            return false;
+        __cpuid_count(0x00000007, 0, info[0], info[1], info[2], info[3]);
+        if(info[1] & (1 << 29)) // SHA
+            return true;
+    }
+    return false;
+}
+
+#ifdef __ELF__
+extern "C" char** _dl_argv;
+#endif
+
+// Whether the environment variable 'name' is set. On ELF targets the environment is read through _dl_argv, so this
+// also works in the ifunc resolver, which runs before the C library is initialized.
+static bool __attribute__((no_sanitize_address)) env_is_set(const char* name) {
+#ifdef __ELF__
+    int argc = *(int*)(_dl_argv - 1);
+    char** my_environ = (char**)(_dl_argv + argc + 1);
+    const size_t len = strlen(name);
+    for(; *my_environ != nullptr; my_environ++) {
+        if(strncmp(*my_environ, name, len) == 0 && ((*my_environ)[len] == '=' || (*my_environ)[len] == 0))
+            return true;
     }
+    return false;
+#else
+    return getenv(name) != nullptr;
+#endif
+}
+
+// the single decision on SHA-NI use, shared by sha256_transform and sha256::digestMany
+static bool __attribute__((no_sanitize_address)) use_sha_ni() {
+    return !env_is_set("BLS_DISABLE_SHANI") && cpu_has_sha();
+}
+
+#ifdef __ELF__
+extern "C" sha256_transform_func_t __attribute__((no_sanitize_address)) resolve_sha256_transform() {
+    if(use_sha_ni())
+        return sha256::transformShaNi;
+    return sha256::transformGeneric;
+}
+
+void sha256_transform(uint32_t*, const uint8_t*, size_t) __attribute__((ifunc("resolve_sha256_transform")));
+#else
+sha256_transform_func_t sha256_transform = sha256::transformGeneric;
+
+struct sha256_transform_init {
+    sha256_transform_init() {
+        if(use_sha_ni())
+            sha256_transform = sha256::transformShaNi;
+    }
+};
+static sha256_transform_init the_sha256_transform_init;
+
+#endif //__ELF__
+#else
+void sha256_transform(uint32_t* state, const uint8_t* data, size_t blocks)
+{
+    sha256::transformGeneric(state, data, blocks);
+}
+#endif
+
+const uint8_t* sha256::lane::block(size_t i) const
+{
+    return i < bodyBlocks ? body + 64 * i : tail + 64 * (i - bodyBlocks);
+}
+
+#define ROTR(x, k) (((x) >> (k)) | ((x) << (32 - (k))))
 
-    for(uint8_t i = 0; i < 64; i++)
+// Multi-buffer SHA-256: each vector element holds the same state word of a different message. Written
+// with generic vector types, the lane width is chosen by the instantiation.
+template<typename V, size_t L>
+inline __attribute__((always_inline)) void sha256::hashLanes(const lane* lanes, size_t n, const uint32_t* state)
+{
+    static const uint8_t zeros[64] = {};
+    alignas(64) uint32_t wt[16][L];
+    V st[8], w[16], a, b, c, d, e, f, g, h, t1, t2;
+
+    for(int j = 0; j < 8; j++)
+    {
+        st[j] = V{} + state[j];
+    }
+    // lanes are sorted by decreasing block count: the first one is the longest
+    for(size_t blk = 0; blk < lanes[0].blocks; blk++)
     {
-        maj   = sha256::majority(state[0], state[1], state[2]);
-        xorA  = sha256::rotr(state[0], 2) ^ sha256::rotr(state[0], 13) ^ sha256::rotr(state[0], 22);
+        for(size_t l = 0; l < L; l++)
+        {
+            const uint8_t* p = l < n && blk < lanes[l].blocks ? lanes[l].block(blk) : zeros;
+            for(int t = 0; t < 16; t++)
+            {
+                uint32_t x;
+                memcpy(&x, p + 4 * t, 4);
+                wt[t][l] = __builtin_bswap32(x);
+            }
+        }
+        memcpy(w, wt, sizeof(w));
+
+        a = st[0]; b = st[1]; c = st[2]; d = st[3];
+        e = st[4]; f = st[5]; g = st[6]; h = st[7];
+        for(int i = 0; i < 64; i++)
+        {
+            if(i >= 16)
+            {
+                V w15 = w[(i - 15) & 15], w2 = w[(i - 2) & 15];
+                w[i & 15] += (ROTR(w2, 17) ^ ROTR(w2, 19) ^ (w2 >> 10)) + w[(i - 7) & 15]
+                           + (ROTR(w15, 7) ^ ROTR(w15, 18) ^ (w15 >> 3));
+            }
+            t1 = h + (ROTR(e, 6) ^ ROTR(e, 11) ^ ROTR(e, 25)) + ((e & f) ^ (~e & g)) + K[i] + w[i & 15];
+            t2 = (ROTR(a, 2) ^ ROTR(a, 13) ^ ROTR(a, 22)) + ((a & (b | c)) | (b & c));
+            h = g; g = f; f = e; e = d + t1;
+            d = c; c = b; b = a; a = t1 + t2;
+        }
+        st[0] += a; st[1] += b; st[2] += c; st[3] += d;
+        st[4] += e; st[5] += f; st[6] += g; st[7] += h;
 
-        ch = choose(state[4], state[5], state[6]);
+        for(size_t l = 0; l < n; l++)
+        {
+            if(lanes[l].blocks == blk + 1)
+            {
+                for(int j = 0; j < 8; j++)
+                {
+                    uint32_t x = __builtin_bswap32(st[j][l]);
+                    memcpy(lanes[l].out + 4 * j, &x, 4);
+                }
+            }
+        }
+    }
+}
+
+#undef ROTR
+
+#ifdef __x86_64__
+typedef uint32_t u32x8 __attribute__((vector_size(32)));
+typedef uint32_t u32x16 __attribute__((vector_size(64)));
+
+__attribute__((target("avx2")))
+void sha256::hashLanesAvx2(const lane* lanes, size_t n, const uint32_t* state)
+{
+    hashLanes<u32x8, 8>(lanes, n, state);
+}
+
+__attribute__((target("avx512f")))
+void sha256::hashLanesAvx512(const lane* lanes, size_t n, const uint32_t* state)
+{
+    hashLanes<u32x16, 16>(lanes, n, state);
+}
+#endif
 
-        xorE  = sha256::rotr(state[4], 6) ^ sha256::rotr(state[4], 11) ^ sha256::rotr(state[4], 25);
+void sha256::digestMany(span<const span<const uint8_t>> msgs, uint8_t* out)
+{
+    digestMany(msgs, out, sha256().state(), 0);
+}
 
-        sum  = m[i] + K[i] + state[7] + ch + xorE;
-        newA = xorA + maj + sum;
-        newE = state[3] + sum;
+void sha256::digestMany(span<const span<const uint8_t>> msgs, uint8_t* out, const array<uint32_t, 8>& state, uint64_t bytes)
+{
+    enum class engine { single, avx2, avx512 };
+    // selected once, on the first call
+    static const engine eng = []() {
+#ifdef __x86_64__
+        // a single SHA-NI stream is about as fast as a full AVX-512 batch and has no batching overhead. Same
+        // decision as sha256_transform, so 'single' here always means the SHA-NI transform.
+        if(use_sha_ni())
+            return engine::single;
+        if(__builtin_cpu_supports("avx512f") && !env_is_set("BLS_DISABLE_AVX512"))
+            return engine::avx512;
+        if(__builtin_cpu_supports("avx2"))
+            return engine::avx2;
+#endif
+        return engine::single;
+    }();
+
+    if(eng == engine::single || msgs.size() < 2)
+    {
+        for(size_t i = 0; i < msgs.size(); i++)
+        {
+            sha256 sha(state, bytes);
+            sha.update(msgs[i].data(), msgs[i].size());
+            sha.digest(out + 32 * i);
+        }
+        return;
+    }
 
-        state[7] = state[6];
-        state[6] = state[5];
-        state[5] = state[4];
-        state[4] = newE;
-        state[3] = state[2];
-        state[2] = state[1];
-        state[1] = state[0];
-        state[0] = newA;
+    vector<lane> lanes(msgs.size());
+    for(size_t i = 0; i < msgs.size(); i++)
+    {
+        lane& l = lanes[i];
+        size_t len = msgs[i].size();
+        size_t rem = len % 64;
+        l.body = msgs[i].data();
+        l.bodyBlocks = len / 64;
+        l.blocks = l.bodyBlocks + (rem < 56 ? 1 : 2);
+        l.out = out + 32 * i;
+        memset(l.tail, 0, sizeof(l.tail));
+        if(rem > 0)
+        {
+            memcpy(l.tail, l.body + 64 * l.bodyBlocks, rem);
+        }
+        l.tail[rem] = 0x80;
+        uint64_t bitlen = (bytes + len) * 8;
+        uint8_t* end = l.tail + 64 * (l.blocks - l.bodyBlocks);
+        for(int j = 1; j <= 8; j++)
+        {
+            end[-j] = bitlen >> (8 * (j - 1));
+        }
     }
+    // group messages of similar length, so the active lanes of a batch form a prefix
+    stable_sort(lanes.begin(), lanes.end(), [](const lane& x, const lane& y) { return x.blocks > y.blocks; });
 
-    for(uint8_t i = 0 ; i < 8 ; i++)
+#ifdef __x86_64__
+    const size_t width = eng == engine::avx512 ? 16 : 8;
+    for(size_t i = 0; i < lanes.size(); i += width)
     {
-        m_state[i] += state[i];
+        size_t n = min(width, lanes.size() - i);
+        if(eng == engine::avx512) hashLanesAvx512(&lanes[i], n, state.data());
+        else                      hashLanesAvx2(&lanes[i], n, state.data());
     }
+#endif
 }
 
 void sha256::pad()
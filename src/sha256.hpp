@@ -2,6 +2,7 @@
 
 #include <string>
 #include <array>
+#include <span>
 #include <cstdint>
 
 using namespace std;
@@ -14,6 +15,8 @@ class sha256
 
 public:
     sha256();
+    // resumes hashing from a state captured after 'bytes' (a multiple of 64) bytes of input
+    sha256(const array<uint32_t, 8>& state, uint64_t bytes);
     void update(const uint8_t * data, size_t length);
     void update(const string &data);
     array<uint8_t, 32> digest();
@@ -21,7 +24,43 @@ public:
 
     static string toString(const array<uint8_t, 32>& digest);
 
+    // the intermediate hash state, only meaningful when the input so far is a multiple of 64 bytes
+    array<uint32_t, 8> state() const;
+    // hashes input that already carries the SHA-256 padding
+    static void digestPadded(const uint8_t* data, size_t blocks, uint8_t* out);
+
+    // hashes many independent messages, the digest of msgs[i] is written to out + 32 * i. Without SHA-NI
+    // the messages are hashed in lockstep, 8 (AVX2) or 16 (AVX-512) at a time.
+    static void digestMany(span<const span<const uint8_t>> msgs, uint8_t* out);
+    // same, each message continuing from a state captured after 'bytes' (a multiple of 64) bytes of input
+    static void digestMany(span<const span<const uint8_t>> msgs, uint8_t* out, const array<uint32_t, 8>& state, uint64_t bytes);
+
+    // compression function implementations, 'sha256_transform' is bound to the fastest one at load time
+    static void transformGeneric(uint32_t* state, const uint8_t* data, size_t blocks);
+#ifdef __x86_64__
+    static void transformShaNi(uint32_t* state, const uint8_t* data, size_t blocks);
+#endif
+
 private:
+    // a message prepared for the multi-lane engine: full blocks are read from 'body', the
+    // padded remainder (one or two blocks) from 'tail'
+    struct lane
+    {
+        const uint8_t* body;
+        size_t bodyBlocks;
+        size_t blocks;
+        uint8_t tail[128];
+        uint8_t* out;
+
+        const uint8_t* block(size_t i) const;
+    };
+
+    template<typename V, size_t L> static void hashLanes(const lane* lanes, size_t n, const uint32_t* state);
+#ifdef __x86_64__
+    static void hashLanesAvx2(const lane* lanes, size_t n, const uint32_t* state);
+    static void hashLanesAvx512(const lane* lanes, size_t n, const uint32_t* state);
+#endif
+
     uint8_t  m_data[64];
     uint32_t m_blocklen;
     uint64_t m_bitlen;
@@ -56,4 +95,13 @@ private:
     void revert(array<uint8_t, 32>& hash);
 };
 
+// processes 'blocks' consecutive 64 byte blocks of 'data'
+#if defined(__x86_64__) && defined(__ELF__)
+extern void sha256_transform(uint32_t* state, const uint8_t* data, size_t blocks);
+#elif defined(__x86_64__)
+extern void (*sha256_transform)(uint32_t* state, const uint8_t* data, size_t blocks);
+#else
+void sha256_transform(uint32_t* state, const uint8_t* data, size_t blocks);
+#endif
+
 } // namespace bls12_381
@@ -1,6 +1,13 @@
 #include <bls12-381/bls12-381.hpp>
 #include "sha256.hpp"
-#include <set>
+#include "parallel.hpp"
+#include <unordered_map>
+#include <string_view>
+#include <random>
+#include <numeric>
+#include <algorithm>
+#include <atomic>
+#include <mutex>
 
 using namespace std;
 
@@ -10,6 +17,14 @@ namespace bls12_381
 // Domain Separation Tags
 const string CIPHERSUITE_ID = "BLS_SIG_BLS12381G2_XMD:SHA-256_SSWU_RO_NUL_";
 const string POP_CIPHERSUITE_ID = "BLS_POP_BLS12381G2_XMD:SHA-256_SSWU_RO_POP_";
+const string CIPHERSUITE_ID_G1 = "BLS_SIG_BLS12381G1_XMD:SHA-256_SSWU_RO_NUL_";
+const string POP_CIPHERSUITE_ID_G1 = "BLS_POP_BLS12381G1_XMD:SHA-256_SSWU_RO_POP_";
+
+// defined after the IDs above, so they are initialized first
+const xmd_expander CIPHERSUITE_XMD(CIPHERSUITE_ID);
+const xmd_expander POP_CIPHERSUITE_XMD(POP_CIPHERSUITE_ID);
+const xmd_expander CIPHERSUITE_XMD_G1(CIPHERSUITE_ID_G1);
+const xmd_expander POP_CIPHERSUITE_XMD_G1(POP_CIPHERSUITE_ID_G1);
 
 int hkdf256_hmac(
     uint8_t *mac,
@@ -277,20 +292,15 @@ void parent_sk_to_lamport_pk(
     ikm_to_lamport_sk(lamport1.data(), notIkm.data(), 32, salt.data(), 4);
 
     array<uint8_t, 32 * 255 * 2> lamportPk;
+    array<span<const uint8_t>, 255 * 2> chunks;
 
+    // the 510 chunk hashes are independent
     for(size_t i = 0; i < 255; i++)
     {
-        sha256 sha;
-        sha.update(lamport0.data() + i * 32, 32);
-        sha.digest(lamportPk.data() + i * 32);
-    }
-
-    for(size_t i=0; i < 255; i++)
-    {
-        sha256 sha;
-        sha.update(lamport1.data() + i * 32, 32);
-        sha.digest(lamportPk.data() + 255 * 32 + i * 32);
+        chunks[i] = span<const uint8_t>(lamport0.data() + i * 32, 32);
+        chunks[255 + i] = span<const uint8_t>(lamport1.data() + i * 32, 32);
     }
+    sha256::digestMany(chunks, lamportPk.data());
     sha256 sha;
     sha.update(lamportPk.data(), 32 * 255 * 2);
     sha.digest(outputLamportPk);
@@ -440,6 +450,47 @@ g1 public_key(const array<uint64_t, 4>& sk)
     return g1::one().scale(sk).affine();
 }
 
+g2 public_key_g2(const array<uint64_t, 4>& sk)
+{
+    return g2::one().scale(sk).affine();
+}
+
+validated_g1::validated_g1(const g1& p) : m_point(p.affine())
+{
+}
+
+optional<validated_g1> validated_g1::validate(const g1& p)
+{
+    if(!p.isOnCurve() || !p.inCorrectSubgroup())
+    {
+        return nullopt;
+    }
+    return validated_g1(p);
+}
+
+const g1& validated_g1::point() const
+{
+    return m_point;
+}
+
+validated_g2::validated_g2(const g2& p) : m_point(p.affine())
+{
+}
+
+optional<validated_g2> validated_g2::validate(const g2& p)
+{
+    if(!p.isOnCurve() || !p.inCorrectSubgroup())
+    {
+        return nullopt;
+    }
+    return validated_g2(p);
+}
+
+const g2& validated_g2::point() const
+{
+    return m_point;
+}
+
 // Construct an extensible-output function based on SHA256
 int xmd_sh256(
     uint8_t *buf,
@@ -493,60 +544,334 @@ int xmd_sh256(
     return 0;
 }
 
+// the b_1 .. b_ell stage of expand_message_xmd for n messages with their b_0 in 'b_0', hashed in lockstep
+static void xmdExpandMany(uint8_t* buf, int buf_len, unsigned ell, const uint8_t* b_0, size_t n, const uint8_t* dst, int dst_len)
+{
+    const unsigned int SHA256HashSize = 32;
+    // b_i = H((b_0 ^ b_(i-1)) || i || DST'), all inputs have the same length
+    const size_t m = SHA256HashSize + 1 + dst_len + 1;
+    vector<uint8_t> b_in(m * n);
+    vector<uint8_t> b_i(SHA256HashSize * n, 0);
+    vector<span<const uint8_t>> spans(n);
+    for (size_t k = 0; k < n; ++k)
+    {
+        memcpy(b_in.data() + k * m + SHA256HashSize + 1, dst, dst_len);
+        b_in[k * m + m - 1] = dst_len;
+        spans[k] = span<const uint8_t>(b_in.data() + k * m, m);
+    }
+    for (unsigned i = 1; i <= ell; ++i)
+    {
+        for (size_t k = 0; k < n; ++k)
+        {
+            for (unsigned j = 0; j < SHA256HashSize; ++j)
+            {
+                b_in[k * m + j] = b_0[k * SHA256HashSize + j] ^ b_i[k * SHA256HashSize + j];
+            }
+            b_in[k * m + SHA256HashSize] = i;
+        }
+        sha256::digestMany(spans, b_i.data());
+        const int rem_after = buf_len - i * SHA256HashSize;
+        const int copy_len = SHA256HashSize + (rem_after < 0 ? rem_after : 0);
+        for (size_t k = 0; k < n; ++k)
+        {
+            memcpy(buf + k * buf_len + (i - 1) * SHA256HashSize, b_i.data() + k * SHA256HashSize, copy_len);
+        }
+    }
+}
 
-g2 fromMessage(
-    std::span<const uint8_t> msg,
-    const string& dst
+int xmd_sh256(
+    uint8_t *buf,
+    int buf_len,
+    std::span<const std::span<const uint8_t>> msgs,
+    const uint8_t *dst,
+    int dst_len
 )
 {
-    uint8_t buf[4 * 64];
-    xmd_sh256(buf, 4 * 64, msg.data(), msg.size(), reinterpret_cast<const uint8_t*>(dst.c_str()), dst.length());
+    const unsigned int SHA256HashSize = 32;
+    const unsigned int SHA256_Message_Block_Size = 64;
+    const unsigned ell = (buf_len + SHA256HashSize - 1) / SHA256HashSize;
+    if (buf_len < 0 || ell > 255 || dst_len > 255)
+    {
+        return -1;
+    }
+    const size_t n = msgs.size();
+    const uint8_t l_i_b_0_str[] = {
+        static_cast<uint8_t>(buf_len >> 8),
+        static_cast<uint8_t>(buf_len & 0xff),
+        0
+    };
+
+    // b_0 = H(Z_pad || msg || l_i_b_str || 0 || DST'), one input per message
+    vector<size_t> offsets(n + 1, 0);
+    for (size_t k = 0; k < n; ++k)
+    {
+        offsets[k + 1] = offsets[k] + SHA256_Message_Block_Size + msgs[k].size() + 3 + dst_len + 1;
+    }
+    vector<uint8_t> in(offsets[n]);
+    vector<span<const uint8_t>> spans(n);
+    for (size_t k = 0; k < n; ++k)
+    {
+        uint8_t* p = in.data() + offsets[k];
+        memset(p, 0, SHA256_Message_Block_Size);
+        p += SHA256_Message_Block_Size;
+        memcpy(p, msgs[k].data(), msgs[k].size());
+        p += msgs[k].size();
+        memcpy(p, l_i_b_0_str, 3);
+        memcpy(p + 3, dst, dst_len);
+        p[3 + dst_len] = dst_len;
+        spans[k] = span<const uint8_t>(in.data() + offsets[k], offsets[k + 1] - offsets[k]);
+    }
+    vector<uint8_t> b_0(SHA256HashSize * n);
+    sha256::digestMany(spans, b_0.data());
+    xmdExpandMany(buf, buf_len, ell, b_0.data(), n, dst, dst_len);
+    return 0;
+}
+
+
+xmd_expander::xmd_expander(const string& dst) : m_dst(dst), m_suffix{}, m_suffixBlocks(0)
+{
+    const uint8_t Z_pad[64] = { 0, };
+    sha256 sha;
+    sha.update(Z_pad, 64);
+    m_midstate = sha.state();
+
+    // b_i = H(b || i || DST || len(DST)), only the first 33 bytes change
+    const size_t len = 32 + 1 + m_dst.size() + 1;
+    if(m_dst.size() > 255)
+    {
+        return;
+    }
+    m_suffixBlocks = (len + 9 + 63) / 64;
+    memcpy(m_suffix.data() + 33, m_dst.data(), m_dst.size());
+    m_suffix[len - 1] = m_dst.size();
+    m_suffix[len] = 0x80;
+    const uint64_t bitlen = len * 8;
+    for(size_t j = 1; j <= 8; j++)
+    {
+        m_suffix[m_suffixBlocks * 64 - j] = bitlen >> (8 * (j - 1));
+    }
+}
+
+int xmd_expander::expand(uint8_t* buf, int buf_len, span<const uint8_t> msg) const
+{
+    const unsigned int SHA256HashSize = 32;
+    const unsigned ell = (buf_len + SHA256HashSize - 1) / SHA256HashSize;
+    if (buf_len < 0 || ell > 255 || m_dst.size() > 255)
+    {
+        return -1;
+    }
+    const uint8_t l_i_b_0_str[] = {
+        static_cast<uint8_t>(buf_len >> 8),
+        static_cast<uint8_t>(buf_len & 0xff),
+        0,
+        static_cast<uint8_t>(m_dst.size())
+    };
+    uint8_t b_0[SHA256HashSize];
+    sha256 sha(m_midstate, 64);
+    sha.update(msg.data(), msg.size());
+    sha.update(l_i_b_0_str, 3);
+    sha.update(reinterpret_cast<const uint8_t*>(m_dst.data()), m_dst.size());
+    sha.update(l_i_b_0_str + 3, 1);
+    sha.digest(b_0);
+
+    array<uint8_t, 5 * 64> b_in = m_suffix;
+    uint8_t b_i[SHA256HashSize] = { 0, };
+    for (unsigned i = 1; i <= ell; ++i)
+    {
+        for (unsigned j = 0; j < SHA256HashSize; ++j)
+        {
+            b_in[j] = b_0[j] ^ b_i[j];
+        }
+        b_in[SHA256HashSize] = i;
+        sha256::digestPadded(b_in.data(), m_suffixBlocks, b_i);
+        const int rem_after = buf_len - i * SHA256HashSize;
+        const int copy_len = SHA256HashSize + (rem_after < 0 ? rem_after : 0);
+        memcpy(buf + (i - 1) * SHA256HashSize, b_i, copy_len);
+    }
+    return 0;
+}
+
+int xmd_expander::expand(uint8_t* buf, int buf_len, span<const span<const uint8_t>> msgs) const
+{
+    const unsigned int SHA256HashSize = 32;
+    const unsigned ell = (buf_len + SHA256HashSize - 1) / SHA256HashSize;
+    if (buf_len < 0 || ell > 255 || m_dst.size() > 255)
+    {
+        return -1;
+    }
+    const size_t n = msgs.size();
+    const uint8_t l_i_b_0_str[] = {
+        static_cast<uint8_t>(buf_len >> 8),
+        static_cast<uint8_t>(buf_len & 0xff),
+        0
+    };
+
+    // b_0 = H(Z_pad || msg || l_i_b_str || 0 || DST'), Z_pad is already absorbed in the midstate
+    vector<size_t> offsets(n + 1, 0);
+    for (size_t k = 0; k < n; ++k)
+    {
+        offsets[k + 1] = offsets[k] + msgs[k].size() + 3 + m_dst.size() + 1;
+    }
+    vector<uint8_t> in(offsets[n]);
+    vector<span<const uint8_t>> spans(n);
+    for (size_t k = 0; k < n; ++k)
+    {
+        uint8_t* p = in.data() + offsets[k];
+        memcpy(p, msgs[k].data(), msgs[k].size());
+        p += msgs[k].size();
+        memcpy(p, l_i_b_0_str, 3);
+        memcpy(p + 3, m_dst.data(), m_dst.size());
+        p[3 + m_dst.size()] = m_dst.size();
+        spans[k] = span<const uint8_t>(in.data() + offsets[k], offsets[k + 1] - offsets[k]);
+    }
+    vector<uint8_t> b_0(SHA256HashSize * n);
+    sha256::digestMany(spans, b_0.data(), m_midstate, 64);
+    xmdExpandMany(buf, buf_len, ell, b_0.data(), n, reinterpret_cast<const uint8_t*>(m_dst.data()), m_dst.size());
+    return 0;
+}
 
+const string& xmd_expander::dst() const
+{
+    return m_dst;
+}
+
+// maps 256 bytes of expanded message to a point in G2
+static g2 mapToG2(const uint8_t* buf)
+{
     array<uint64_t, 8> k = {};
     fp2 t = fp2::zero();
-    fp2 x, y, z = fp2::one();
     g2 p, q;
 
-    k = scalar::fromBytesBE<8>(span<uint8_t, 64>(buf, buf + 64));
+    k = scalar::fromBytesBE<8>(span<const uint8_t, 64>(buf, buf + 64));
     t.c0 = fp::modPrime(k);
-    k = scalar::fromBytesBE<8>(span<uint8_t, 64>(buf + 64, buf + 2*64));
+    k = scalar::fromBytesBE<8>(span<const uint8_t, 64>(buf + 64, buf + 2*64));
     t.c1 = fp::modPrime(k);
 
-    tie(x, y) = g2::swuMapG2(t);
-    p = g2({x, y, z}).isogenyMap();
+    p = g2::swuMap(t).isogenyMap();
 
-    k = scalar::fromBytesBE<8>(span<uint8_t, 64>(buf + 2*64, buf + 3*64));
+    k = scalar::fromBytesBE<8>(span<const uint8_t, 64>(buf + 2*64, buf + 3*64));
     t.c0 = fp::modPrime(k);
-    k = scalar::fromBytesBE<8>(span<uint8_t, 64>(buf + 3*64, buf + 4*64));
+    k = scalar::fromBytesBE<8>(span<const uint8_t, 64>(buf + 3*64, buf + 4*64));
     t.c1 = fp::modPrime(k);
 
-    tie(x, y) = g2::swuMapG2(t);
-    q = g2({x, y, z}).isogenyMap();
+    q = g2::swuMap(t).isogenyMap();
+
+    return p.add(q).clearCofactor();
+}
+
+g2 fromMessage(
+    std::span<const uint8_t> msg,
+    const string& dst
+)
+{
+    if(dst == CIPHERSUITE_ID)
+    {
+        return fromMessage(msg, CIPHERSUITE_XMD);
+    }
+    if(dst == POP_CIPHERSUITE_ID)
+    {
+        return fromMessage(msg, POP_CIPHERSUITE_XMD);
+    }
+    uint8_t buf[4 * 64];
+    xmd_sh256(buf, 4 * 64, msg.data(), msg.size(), reinterpret_cast<const uint8_t*>(dst.c_str()), dst.length());
+    return mapToG2(buf);
+}
+
+g2 fromMessage(
+    std::span<const uint8_t> msg,
+    const xmd_expander& xmd
+)
+{
+    uint8_t buf[4 * 64];
+    xmd.expand(buf, 4 * 64, msg);
+    return mapToG2(buf);
+}
+
+vector<g2> fromMessages(
+    std::span<const std::span<const uint8_t>> msgs,
+    const string& dst,
+    size_t threads
+)
+{
+    // the ciphersuite DSTs use the precomputed expanders, like fromMessage
+    const xmd_expander* xmd = dst == CIPHERSUITE_ID ? &CIPHERSUITE_XMD : dst == POP_CIPHERSUITE_ID ? &POP_CIPHERSUITE_XMD : nullptr;
+    vector<g2> out(msgs.size());
+    parallel_for(msgs.size(), threads, [&](size_t begin, size_t end) {
+        const size_t n = end - begin;
+        vector<uint8_t> buf(n * 4 * 64);
+        if(xmd)
+        {
+            xmd->expand(buf.data(), 4 * 64, msgs.subspan(begin, n));
+        }
+        else
+        {
+            xmd_sh256(buf.data(), 4 * 64, msgs.subspan(begin, n), reinterpret_cast<const uint8_t*>(dst.c_str()), dst.length());
+        }
+
+        for(size_t i = 0; i < n; i++)
+        {
+            out[begin + i] = mapToG2(buf.data() + i * 4 * 64);
+        }
+    });
+    return out;
+}
 
+// maps 128 bytes of expanded message to a point in G1
+static g1 mapToG1(const uint8_t* buf)
+{
+    array<uint64_t, 8> k = scalar::fromBytesBE<8>(span<const uint8_t, 64>(buf, buf + 64));
+    g1 p = g1::swuMap(fp::modPrime(k)).isogenyMap();
+    k = scalar::fromBytesBE<8>(span<const uint8_t, 64>(buf + 64, buf + 2*64));
+    g1 q = g1::swuMap(fp::modPrime(k)).isogenyMap();
     return p.add(q).clearCofactor();
 }
 
+g1 fromMessageG1(
+    std::span<const uint8_t> msg,
+    const string& dst
+)
+{
+    if(dst == CIPHERSUITE_ID_G1)
+    {
+        return fromMessageG1(msg, CIPHERSUITE_XMD_G1);
+    }
+    if(dst == POP_CIPHERSUITE_ID_G1)
+    {
+        return fromMessageG1(msg, POP_CIPHERSUITE_XMD_G1);
+    }
+    uint8_t buf[2 * 64];
+    xmd_sh256(buf, 2 * 64, msg.data(), msg.size(), reinterpret_cast<const uint8_t*>(dst.c_str()), dst.length());
+    return mapToG1(buf);
+}
+
+g1 fromMessageG1(
+    std::span<const uint8_t> msg,
+    const xmd_expander& xmd
+)
+{
+    uint8_t buf[2 * 64];
+    xmd.expand(buf, 2 * 64, msg);
+    return mapToG1(buf);
+}
+
 g2 sign(
     const array<uint64_t, 4>& sk,
     std::span<const uint8_t> msg
 )
 {
-    g2 p = fromMessage(msg, CIPHERSUITE_ID);
+    g2 p = fromMessage(msg, CIPHERSUITE_XMD);
     return p.scale(sk);
 }
 
-bool verify(
+// 'checkPubkey' is false for public keys that are already known to be valid
+static bool verifyImpl(
     const g1& pubkey,
     std::span<const uint8_t> message,
-    const g2& signature
+    const g2& signature,
+    bool checkPubkey
 )
 {
-    vector<tuple<g1, g2>> v;
-    pairing::add_pair(v, g1::one().negate(), signature);
-    const g2 hashedPoint = fromMessage(message, CIPHERSUITE_ID);
-    pairing::add_pair(v, pubkey, hashedPoint);
-
-    if(!pubkey.isOnCurve() || !pubkey.inCorrectSubgroup())
+    if(checkPubkey && (!pubkey.isOnCurve() || !pubkey.inCorrectSubgroup()))
     {
         return false;
     }
@@ -555,10 +880,33 @@ bool verify(
         return false;
     }
 
+    vector<tuple<g1, g2>> v;
+    pairing::add_pair(v, g1::one().negate(), signature);
+    const g2 hashedPoint = fromMessage(message, CIPHERSUITE_XMD);
+    pairing::add_pair(v, pubkey, hashedPoint);
+
     // 1 =? prod e(pubkey[i], hash[i]) * e(-g1, aggSig)
     return fp12::one().equal(pairing::calculate(v));
 }
 
+bool verify(
+    const g1& pubkey,
+    std::span<const uint8_t> message,
+    const g2& signature
+)
+{
+    return verifyImpl(pubkey, message, signature, true);
+}
+
+bool verify(
+    const validated_g1& pubkey,
+    std::span<const uint8_t> message,
+    const g2& signature
+)
+{
+    return verifyImpl(pubkey.point(), message, signature, false);
+}
+
 g1 aggregate_public_keys(std::span<const g1> pks)
 {
     g1 agg_pk = g1({fp::zero(), fp::zero(), fp::zero()});
@@ -569,6 +917,16 @@ g1 aggregate_public_keys(std::span<const g1> pks)
     return agg_pk;
 }
 
+g1 aggregate_public_keys(std::span<const g1_affine> pks)
+{
+    g1 agg_pk = g1::zero();
+    for(const g1_affine& pk : pks)
+    {
+        agg_pk.addAssign(pk);
+    }
+    return agg_pk;
+}
+
 g2 aggregate_signatures(std::span<const g2> sigs)
 {
     g2 agg_sig = g2({fp2::zero(), fp2::zero(), fp2::zero()});
@@ -579,11 +937,79 @@ g2 aggregate_signatures(std::span<const g2> sigs)
     return agg_sig;
 }
 
-bool aggregate_verify(
-    std::span<const g1> pubkeys,
+// Uniform access to plain and validated points, only the plain ones are checked on use.
+// The subgroup checks of a span of points are batched.
+static bool allValid(std::span<const g1> points)
+{
+    return all_of(points.begin(), points.end(), [](const g1& p) { return p.isOnCurve(); }) && g1::batchInCorrectSubgroup(points);
+}
+
+static bool allValid(std::span<const g2> points)
+{
+    return all_of(points.begin(), points.end(), [](const g2& p) { return p.isOnCurve(); }) && g2::batchInCorrectSubgroup(points);
+}
+
+static bool allValid(std::span<const validated_g1>)
+{
+    return true;
+}
+
+static bool allValid(std::span<const validated_g2>)
+{
+    return true;
+}
+
+static const g1& keyPoint(const g1& pk)
+{
+    return pk;
+}
+
+static const g2& keyPoint(const g2& pk)
+{
+    return pk;
+}
+
+static const g1& keyPoint(const validated_g1& pk)
+{
+    return pk.point();
+}
+
+static const g2& keyPoint(const validated_g2& pk)
+{
+    return pk.point();
+}
+
+// Groups 'messages' by content in O(n): returns the distinct messages in order of first appearance and
+// sets group[i] to the index of the distinct message equal to messages[i]
+static vector<span<const uint8_t>> groupMessages(
+    std::span<const std::vector<uint8_t>> messages,
+    vector<size_t>& group
+)
+{
+    unordered_map<string_view, size_t> groupOf;
+    groupOf.reserve(messages.size());
+    vector<span<const uint8_t>> unique;
+    group.resize(messages.size());
+    for(size_t i = 0; i < messages.size(); i++)
+    {
+        string_view key(reinterpret_cast<const char*>(messages[i].data()), messages[i].size());
+        auto [it, inserted] = groupOf.try_emplace(key, unique.size());
+        if(inserted)
+        {
+            unique.push_back(messages[i]);
+        }
+        group[i] = it->second;
+    }
+    return unique;
+}
+
+template<typename PK>
+static bool aggregateVerify(
+    std::span<const PK> pubkeys,
     std::span<const std::vector<uint8_t>> messages,
     const g2& signature,
-    const bool checkForDuplicateMessages
+    const bool checkForDuplicateMessages,
+    size_t threads
 )
 {
     vector<tuple<g1, g2>> v;
@@ -599,51 +1025,301 @@ bool aggregate_verify(
         return false;
     }
 
-    if(checkForDuplicateMessages)
+    // Group the inputs by message: e(pk1, H(m)) * e(pk2, H(m)) = e(pk1 + pk2, H(m)), so every distinct message
+    // is hashed and paired once with the sum of its public keys. The grouping also detects duplicates.
+    vector<size_t> group;
+    vector<span<const uint8_t>> unique = groupMessages(messages, group);
+    if(checkForDuplicateMessages && unique.size() != messages.size())
     {
-        // A std::set will filter out duplicates on calls of 'insert'
-        set<vector<uint8_t>> setMessages;
-        for(const auto& message : messages)
-        {
-            setMessages.insert({message.begin(), message.end()});
-        }
-        // if it still has the same size as the vector from before all messages are unique
-        if(setMessages.size() != pubkeys.size())
-        {
-            return false;
-        }
+        return false;
     }
 
+    atomic<bool> valid = true;
+    parallel_for(pubkeys.size(), threads, [&](size_t begin, size_t end) {
+        if(!allValid(pubkeys.subspan(begin, end - begin)))
+        {
+            valid = false;
+        }
+    });
+    if(!valid)
+    {
+        return false;
+    }
+    vector<g1> groupPks(unique.size(), g1({fp::zero(), fp::zero(), fp::zero()}));
     for(size_t i = 0; i < pubkeys.size(); i++)
     {
-        if(!pubkeys[i].isOnCurve() || !pubkeys[i].inCorrectSubgroup())
+        groupPks[group[i]].addAssign(keyPoint(pubkeys[i]));
+    }
+
+    // The hashing and the Miller loop of every chunk of groups run concurrently. Miller loop values multiply,
+    // so the partial results of all chunks combine into the one of the whole multi-pairing. The identity
+    // signature leaves 'v' empty, which the Miller loop must not be run on.
+    fp12 f = v.empty() ? fp12::one() : pairing::miller_loop(v, std::function<void()>());
+    mutex m;
+    parallel_for(unique.size(), threads, [&](size_t begin, size_t end) {
+        vector<g2> hashes = fromMessages(span<const span<const uint8_t>>(unique).subspan(begin, end - begin), CIPHERSUITE_ID);
+        vector<tuple<g1, g2>> pairs;
+        pairs.reserve(end - begin);
+        for(size_t i = begin; i < end; i++)
         {
-            return false;
+            pairing::add_pair(pairs, groupPks[i], hashes[i - begin]);
         }
-        pairing::add_pair(v, pubkeys[i], fromMessage(messages[i], CIPHERSUITE_ID));
-    }
+        // keys that sum to the identity for every message of the chunk leave no pair
+        if(pairs.empty())
+        {
+            return;
+        }
+        fp12 partial = pairing::miller_loop(pairs, std::function<void()>());
+        lock_guard<mutex> lock(m);
+        f = f.multiply(partial);
+    });
 
     // 1 =? prod e(pubkey[i], hash[i]) * e(-g1, aggSig)
-    return fp12::one().equal(pairing::calculate(v));
+    pairing::final_exponentiation(f);
+    return fp12::one().equal(f);
+}
+
+bool aggregate_verify(
+    std::span<const g1> pubkeys,
+    std::span<const std::vector<uint8_t>> messages,
+    const g2& signature,
+    const bool checkForDuplicateMessages,
+    size_t threads
+)
+{
+    return aggregateVerify(pubkeys, messages, signature, checkForDuplicateMessages, threads);
+}
+
+bool aggregate_verify(
+    std::span<const validated_g1> pubkeys,
+    std::span<const std::vector<uint8_t>> messages,
+    const g2& signature,
+    const bool checkForDuplicateMessages,
+    size_t threads
+)
+{
+    return aggregateVerify(pubkeys, messages, signature, checkForDuplicateMessages, threads);
+}
+
+// Shared state of a batch verification: the random weights r[i], the weighted public keys r[i] * pubkey[i]
+// and the hashed messages, so that sub-batches can be re-checked without redoing any of it.
+struct weighted_batch
+{
+    vector<array<uint64_t, 4>> r;
+    vector<g1> pks;
+    vector<g2> hashes;
+};
+
+static weighted_batch prepareBatch(
+    std::span<const g1> pubkeys,
+    std::span<const std::span<const uint8_t>> messages
+)
+{
+    // Weight every equation with a random non-zero 64 bit scalar r[i] so that invalid signatures cannot
+    // cancel each other out: 1 =? prod e(r[i] * pubkey[i], hash[i]) * e(-g1, sum r[i] * sig[i])
+    const size_t n = pubkeys.size();
+    weighted_batch b;
+    random_device rd;
+    b.r.resize(n);
+    b.pks.resize(n);
+    for(size_t i = 0; i < n; i++)
+    {
+        while(b.r[i][0] == 0)
+        {
+            b.r[i][0] = static_cast<uint64_t>(rd()) << 32 | rd();
+        }
+        b.pks[i] = pubkeys[i].scale(array<uint64_t, 1>{b.r[i][0]});
+    }
+    b.hashes = fromMessages(messages, CIPHERSUITE_ID);
+    return b;
+}
+
+// GT value of the weighted batch equation restricted to the entries 'idx', one means all of them are valid
+static fp12 batchEquation(
+    const weighted_batch& b,
+    std::span<const g2> signatures,
+    std::span<const size_t> idx
+)
+{
+    vector<tuple<g1, g2>> v;
+    vector<g2> sigs;
+    vector<array<uint64_t, 4>> r;
+    v.reserve(idx.size() + 1);
+    sigs.reserve(idx.size());
+    r.reserve(idx.size());
+    for(size_t i : idx)
+    {
+        pairing::add_pair(v, b.pks[i], b.hashes[i]);
+        sigs.push_back(signatures[i]);
+        r.push_back(b.r[i]);
+    }
+    pairing::add_pair(v, g1::one().negate(), g2::weightedSum(sigs, r));
+    return pairing::calculate(v);
+}
+
+bool batch_verify(
+    std::span<const g1> pubkeys,
+    std::span<const std::span<const uint8_t>> messages,
+    std::span<const g2> signatures
+)
+{
+    const size_t n = pubkeys.size();
+    if(n == 0 || messages.size() != n || signatures.size() != n)
+    {
+        return false;
+    }
+
+    if(!allValid(pubkeys) || !allValid(signatures))
+    {
+        return false;
+    }
+
+    weighted_batch b = prepareBatch(pubkeys, messages);
+    vector<size_t> idx(n);
+    iota(idx.begin(), idx.end(), 0);
+    return fp12::one().equal(batchEquation(b, signatures, idx));
+}
+
+// 'e' is the GT value of the batch equation over 'idx'. The equation is a product over its entries after the
+// final exponentiation, so the right half is e * conj(e_left) and only the left half needs another pairing.
+static void bisectBatch(
+    const weighted_batch& b,
+    std::span<const g2> signatures,
+    std::span<const size_t> idx,
+    const fp12& e,
+    vector<size_t>& invalid
+)
+{
+    if(e.equal(fp12::one()))
+    {
+        return;
+    }
+    if(idx.size() == 1)
+    {
+        invalid.push_back(idx[0]);
+        return;
+    }
+    std::span<const size_t> left = idx.first(idx.size() / 2);
+    std::span<const size_t> right = idx.subspan(idx.size() / 2);
+    fp12 eLeft = batchEquation(b, signatures, left);
+    fp12 eRight = e.multiply(eLeft.conjugate());
+    bisectBatch(b, signatures, left, eLeft, invalid);
+    bisectBatch(b, signatures, right, eRight, invalid);
+}
+
+optional<vector<size_t>> batch_verify_find_invalid(
+    std::span<const g1> pubkeys,
+    std::span<const std::span<const uint8_t>> messages,
+    std::span<const g2> signatures
+)
+{
+    const size_t n = pubkeys.size();
+    if(messages.size() != n || signatures.size() != n)
+    {
+        return nullopt;
+    }
+
+    // entries with invalid points are reported right away and kept out of the batch, the subgroup checks
+    // of the points on the curve are batched
+    vector<bool> bad(n);
+    vector<size_t> onCurve;
+    vector<g1> pks;
+    vector<g2> sigs;
+    for(size_t i = 0; i < n; i++)
+    {
+        bad[i] = !pubkeys[i].isOnCurve() || !signatures[i].isOnCurve();
+        if(!bad[i])
+        {
+            onCurve.push_back(i);
+            pks.push_back(pubkeys[i]);
+            sigs.push_back(signatures[i]);
+        }
+    }
+    for(size_t j : g1::batchFindNotInCorrectSubgroup(pks))
+    {
+        bad[onCurve[j]] = true;
+    }
+    for(size_t j : g2::batchFindNotInCorrectSubgroup(sigs))
+    {
+        bad[onCurve[j]] = true;
+    }
+    vector<size_t> invalid;
+    vector<size_t> idx;
+    idx.reserve(n);
+    for(size_t i = 0; i < n; i++)
+    {
+        if(bad[i])
+        {
+            invalid.push_back(i);
+        }
+        else
+        {
+            idx.push_back(i);
+        }
+    }
+    if(!idx.empty())
+    {
+        weighted_batch b = prepareBatch(pubkeys, messages);
+        bisectBatch(b, signatures, idx, batchEquation(b, signatures, idx), invalid);
+        sort(invalid.begin(), invalid.end());
+    }
+    return invalid;
+}
+
+// the batch verifiers work on Jacobian points, the affine inputs convert without inversions
+static vector<g1> toJacobian(std::span<const g1_affine> points)
+{
+    vector<g1> out(points.size());
+    for(size_t i = 0; i < points.size(); i++)
+    {
+        out[i] = points[i].toJacobian();
+    }
+    return out;
+}
+
+static vector<g2> toJacobian(std::span<const g2_affine> points)
+{
+    vector<g2> out(points.size());
+    for(size_t i = 0; i < points.size(); i++)
+    {
+        out[i] = points[i].toJacobian();
+    }
+    return out;
+}
+
+bool batch_verify(
+    std::span<const g1_affine> pubkeys,
+    std::span<const std::span<const uint8_t>> messages,
+    std::span<const g2_affine> signatures
+)
+{
+    return batch_verify(toJacobian(pubkeys), messages, toJacobian(signatures));
+}
+
+optional<vector<size_t>> batch_verify_find_invalid(
+    std::span<const g1_affine> pubkeys,
+    std::span<const std::span<const uint8_t>> messages,
+    std::span<const g2_affine> signatures
+)
+{
+    return batch_verify_find_invalid(toJacobian(pubkeys), messages, toJacobian(signatures));
 }
 
 g2 pop_prove(const array<uint64_t, 4>& sk)
 {
     g1 pk = public_key(sk);
     array<uint8_t, 96> msg = pk.toAffineBytesLE(from_mont::yes);
-    g2 hashed_key = fromMessage(vector<uint8_t>(msg.begin(), msg.end()), POP_CIPHERSUITE_ID);
+    g2 hashed_key = fromMessage(msg, POP_CIPHERSUITE_XMD);
     return hashed_key.scale(sk);
 }
 
-bool pop_verify(
+static bool popVerifyImpl(
     const g1& pubkey,
-    const g2& signature_proof
+    const g2& signature_proof,
+    bool checkPubkey
 )
 {
-    array<uint8_t, 96> msg = pubkey.toAffineBytesLE(from_mont::yes);
-    const g2 hashedPoint = fromMessage(vector<uint8_t>(msg.begin(), msg.end()), POP_CIPHERSUITE_ID);
-
-    if(!pubkey.isOnCurve() || !pubkey.inCorrectSubgroup())
+    if(checkPubkey && (!pubkey.isOnCurve() || !pubkey.inCorrectSubgroup()))
     {
         return false;
     }
@@ -652,6 +1328,8 @@ bool pop_verify(
         return false;
     }
 
+    array<uint8_t, 96> msg = pubkey.toAffineBytesLE(from_mont::yes);
+    const g2 hashedPoint = fromMessage(msg, POP_CIPHERSUITE_XMD);
     vector<tuple<g1, g2>> v;
     pairing::add_pair(v, g1::one().negate(), signature_proof);
     pairing::add_pair(v, pubkey, hashedPoint);
@@ -660,6 +1338,22 @@ bool pop_verify(
     return fp12::one().equal(pairing::calculate(v));
 }
 
+bool pop_verify(
+    const g1& pubkey,
+    const g2& signature_proof
+)
+{
+    return popVerifyImpl(pubkey, signature_proof, true);
+}
+
+bool pop_verify(
+    const validated_g1& pubkey,
+    const g2& signature_proof
+)
+{
+    return popVerifyImpl(pubkey.point(), signature_proof, false);
+}
+
 bool pop_fast_aggregate_verify(
     std::span<const g1> pubkeys,
     std::span<const uint8_t> message,
@@ -674,4 +1368,255 @@ bool pop_fast_aggregate_verify(
     return verify(aggregate_public_keys(pubkeys), message, signature);
 }
 
+bool pop_fast_aggregate_verify(
+    std::span<const validated_g1> pubkeys,
+    std::span<const uint8_t> message,
+    const g2& signature
+)
+{
+    if(pubkeys.size() == 0)
+    {
+        return false;
+    }
+
+    // the sum of valid keys is valid, so it is not checked again
+    g1 agg_pk = g1({fp::zero(), fp::zero(), fp::zero()});
+    for(const validated_g1& pk : pubkeys)
+    {
+        agg_pk.addAssign(pk.point());
+    }
+    return verifyImpl(agg_pk, message, signature, false);
+}
+
+g1 sign_g1(
+    const array<uint64_t, 4>& sk,
+    std::span<const uint8_t> msg
+)
+{
+    g1 p = fromMessageG1(msg, CIPHERSUITE_XMD_G1);
+    return p.scale(sk);
+}
+
+static bool verifyImplG1(
+    const g2& pubkey,
+    std::span<const uint8_t> message,
+    const g1& signature,
+    bool checkPubkey
+)
+{
+    if(checkPubkey && (!pubkey.isOnCurve() || !pubkey.inCorrectSubgroup()))
+    {
+        return false;
+    }
+    if(!signature.isOnCurve() || !signature.inCorrectSubgroup())
+    {
+        return false;
+    }
+
+    vector<tuple<g1, g2>> v;
+    pairing::add_pair(v, signature, g2::one().negate());
+    const g1 hashedPoint = fromMessageG1(message, CIPHERSUITE_XMD_G1);
+    pairing::add_pair(v, hashedPoint, pubkey);
+
+    // 1 =? prod e(hash[i], pubkey[i]) * e(aggSig, -g2)
+    return fp12::one().equal(pairing::calculate(v));
+}
+
+bool verify_g1(
+    const g2& pubkey,
+    std::span<const uint8_t> message,
+    const g1& signature
+)
+{
+    return verifyImplG1(pubkey, message, signature, true);
+}
+
+bool verify_g1(
+    const validated_g2& pubkey,
+    std::span<const uint8_t> message,
+    const g1& signature
+)
+{
+    return verifyImplG1(pubkey.point(), message, signature, false);
+}
+
+g2 aggregate_public_keys_g2(std::span<const g2> pks)
+{
+    g2 agg_pk = g2({fp2::zero(), fp2::zero(), fp2::zero()});
+    for(const g2& pk : pks)
+    {
+        agg_pk = agg_pk.add(pk);
+    }
+    return agg_pk;
+}
+
+g2 aggregate_public_keys_g2(std::span<const g2_affine> pks)
+{
+    g2 agg_pk = g2::zero();
+    for(const g2_affine& pk : pks)
+    {
+        agg_pk.addAssign(pk);
+    }
+    return agg_pk;
+}
+
+g1 aggregate_signatures_g1(std::span<const g1> sigs)
+{
+    g1 agg_sig = g1({fp::zero(), fp::zero(), fp::zero()});
+    for(const g1& sig : sigs)
+    {
+        agg_sig = agg_sig.add(sig);
+    }
+    return agg_sig;
+}
+
+template<typename PK>
+static bool aggregateVerifyG1(
+    std::span<const PK> pubkeys,
+    std::span<const std::vector<uint8_t>> messages,
+    const g1& signature,
+    const bool checkForDuplicateMessages
+)
+{
+    vector<tuple<g1, g2>> v;
+    pairing::add_pair(v, signature, g2::one().negate());
+
+    if(!signature.isOnCurve() || !signature.inCorrectSubgroup())
+    {
+        return false;
+    }
+
+    if(pubkeys.size() != messages.size())
+    {
+        return false;
+    }
+
+    vector<size_t> group;
+    vector<span<const uint8_t>> unique = groupMessages(messages, group);
+    if(checkForDuplicateMessages && unique.size() != messages.size())
+    {
+        return false;
+    }
+
+    if(!allValid(pubkeys))
+    {
+        return false;
+    }
+    vector<g2> groupPks(unique.size(), g2({fp2::zero(), fp2::zero(), fp2::zero()}));
+    for(size_t i = 0; i < pubkeys.size(); i++)
+    {
+        groupPks[group[i]].addAssign(keyPoint(pubkeys[i]));
+    }
+    for(size_t i = 0; i < unique.size(); i++)
+    {
+        pairing::add_pair(v, fromMessageG1(unique[i], CIPHERSUITE_XMD_G1), groupPks[i]);
+    }
+
+    // 1 =? prod e(hash[i], pubkey[i]) * e(aggSig, -g2)
+    return fp12::one().equal(pairing::calculate(v));
+}
+
+bool aggregate_verify_g1(
+    std::span<const g2> pubkeys,
+    std::span<const std::vector<uint8_t>> messages,
+    const g1& signature,
+    const bool checkForDuplicateMessages
+)
+{
+    return aggregateVerifyG1(pubkeys, messages, signature, checkForDuplicateMessages);
+}
+
+bool aggregate_verify_g1(
+    std::span<const validated_g2> pubkeys,
+    std::span<const std::vector<uint8_t>> messages,
+    const g1& signature,
+    const bool checkForDuplicateMessages
+)
+{
+    return aggregateVerifyG1(pubkeys, messages, signature, checkForDuplicateMessages);
+}
+
+g1 pop_prove_g1(const array<uint64_t, 4>& sk)
+{
+    g2 pk = public_key_g2(sk);
+    array<uint8_t, 192> msg = pk.toAffineBytesLE(from_mont::yes);
+    g1 hashed_key = fromMessageG1(msg, POP_CIPHERSUITE_XMD_G1);
+    return hashed_key.scale(sk);
+}
+
+static bool popVerifyImplG1(
+    const g2& pubkey,
+    const g1& signature_proof,
+    bool checkPubkey
+)
+{
+    if(checkPubkey && (!pubkey.isOnCurve() || !pubkey.inCorrectSubgroup()))
+    {
+        return false;
+    }
+    if(!signature_proof.isOnCurve() || !signature_proof.inCorrectSubgroup())
+    {
+        return false;
+    }
+
+    array<uint8_t, 192> msg = pubkey.toAffineBytesLE(from_mont::yes);
+    const g1 hashedPoint = fromMessageG1(msg, POP_CIPHERSUITE_XMD_G1);
+    vector<tuple<g1, g2>> v;
+    pairing::add_pair(v, signature_proof, g2::one().negate());
+    pairing::add_pair(v, hashedPoint, pubkey);
+
+    // 1 =? prod e(hash[i], pubkey[i]) * e(aggSig, -g2)
+    return fp12::one().equal(pairing::calculate(v));
+}
+
+bool pop_verify_g1(
+    const g2& pubkey,
+    const g1& signature_proof
+)
+{
+    return popVerifyImplG1(pubkey, signature_proof, true);
+}
+
+bool pop_verify_g1(
+    const validated_g2& pubkey,
+    const g1& signature_proof
+)
+{
+    return popVerifyImplG1(pubkey.point(), signature_proof, false);
+}
+
+bool pop_fast_aggregate_verify_g1(
+    std::span<const g2> pubkeys,
+    std::span<const uint8_t> message,
+    const g1& signature
+)
+{
+    if(pubkeys.size() == 0)
+    {
+        return false;
+    }
+
+    return verify_g1(aggregate_public_keys_g2(pubkeys), message, signature);
+}
+
+bool pop_fast_aggregate_verify_g1(
+    std::span<const validated_g2> pubkeys,
+    std::span<const uint8_t> message,
+    const g1& signature
+)
+{
+    if(pubkeys.size() == 0)
+    {
+        return false;
+    }
+
+    // the sum of valid keys is valid, so it is not checked again
+    g2 agg_pk = g2({fp2::zero(), fp2::zero(), fp2::zero()});
+    for(const validated_g2& pk : pubkeys)
+    {
+        agg_pk.addAssign(pk.point());
+    }
+    return verifyImplG1(agg_pk, message, signature, false);
+}
+
 } // namespace bls12_381
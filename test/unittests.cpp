@@ -2,6 +2,8 @@
 #include <vector>
 #include <random>
 #include <iostream>
+#include <fstream>
+#include <filesystem>
 
 #include <bls12-381/bls12-381.hpp>
 
@@ -543,6 +545,146 @@ void TestExp() {
     }
 }
 
+void TestSparseMultiplication()
+{
+    // sparse line products must agree with the dense multiplication
+    for(int i = 0; i < 10; i++)
+    {
+        fp2 e0 = random_fe2(), e1 = random_fe2(), e4 = random_fe2();
+        fp2 d0 = random_fe2(), d1 = random_fe2(), d4 = random_fe2();
+        fp12 e = fp12({fp6({e0, e1, fp2::zero()}), fp6({fp2::zero(), e4, fp2::zero()})});
+        fp12 d = fp12({fp6({d0, d1, fp2::zero()}), fp6({fp2::zero(), d4, fp2::zero()})});
+        fp12 ed = fp12::mul014By014(e0, e1, e4, d0, d1, d4);
+        if(!ed.equal(e.multiply(d)))
+        {
+            throw invalid_argument("mul014By014 != multiply");
+        }
+        fp12 f = random_fe12();
+        fp12 expected = f.multiply(ed);
+        f.mulBy01245Assign(ed);
+        if(!f.equal(expected))
+        {
+            throw invalid_argument("mulBy01245Assign != multiply");
+        }
+        f = random_fe12();
+        expected = f.multiply(e);
+        f.mulBy014Assign(e0, e1, e4);
+        if(!f.equal(expected))
+        {
+            throw invalid_argument("mulBy014Assign != multiply");
+        }
+    }
+}
+
+void TestCyclotomicCompressed()
+{
+    // map random elements into the cyclotomic subgroup with the easy part of the final exponentiation
+    for(int i = 0; i < 10; i++)
+    {
+        fp12 f = random_fe12();
+        fp12 g = f.conjugate().multiply(f.inverse());
+        g = g.frobeniusMap(2).multiply(g);
+        fp12 c = g.cyclotomicSquareCompressed().cyclotomicSquareCompressed();
+        if(!c.decompressKarabina().equal(g.cyclotomicSquare().cyclotomicSquare()))
+        {
+            throw invalid_argument("compressed cyclotomic square != cyclotomic square");
+        }
+        if(!g.cyclotomicExpCompressed(g2::cofactorEFF).equal(g.cyclotomicExp(g2::cofactorEFF)))
+        {
+            throw invalid_argument("cyclotomicExpCompressed != cyclotomicExp");
+        }
+        array<uint64_t, 4> k = random_scalar();
+        if(!g.cyclotomicExpCompressed(k).equal(g.cyclotomicExp(k)))
+        {
+            throw invalid_argument("cyclotomicExpCompressed != cyclotomicExp, random scalar");
+        }
+    }
+    if(!fp12::one().cyclotomicExpCompressed(g2::cofactorEFF).isOne())
+    {
+        throw invalid_argument("cyclotomicExpCompressed of one != one");
+    }
+}
+
+void TestGtCompression()
+{
+    vector<fp12> elems = {fp12::one(), fp12::one().negate()};
+    for(int i = 0; i < 5; i++)
+    {
+        vector<tuple<g1, g2>> v;
+        pairing::add_pair(v, random_g1(), random_g2());
+        elems.push_back(pairing::calculate(v));
+    }
+    vector<array<uint8_t, 288>> be, le;
+    for(const fp12& e : elems)
+    {
+        be.push_back(e.toCompressedBytesBE());
+        le.push_back(e.toCompressedBytesLE());
+        optional<fp12> r = fp12::fromCompressedBytesBE(be.back());
+        if(!r || !r->equal(e))
+        {
+            throw invalid_argument("compressed GT round trip failed, BE");
+        }
+        r = fp12::fromCompressedBytesLE(le.back());
+        if(!r || !r->equal(e))
+        {
+            throw invalid_argument("compressed GT round trip failed, LE");
+        }
+        r = fp12::fromCompressedBytesBE(e.toCompressedBytesBE(from_mont::no), { .check_valid = true, .to_mont = false });
+        if(!r || !r->equal(e))
+        {
+            throw invalid_argument("compressed GT round trip failed, montgomery");
+        }
+    }
+    optional<vector<fp12>> batchBE = fp12::fromCompressedBytesBE(span<const array<uint8_t, 288>>(be));
+    optional<vector<fp12>> batchLE = fp12::fromCompressedBytesLE(span<const array<uint8_t, 288>>(le));
+    if(!batchBE || !batchLE || batchBE->size() != elems.size() || batchLE->size() != elems.size())
+    {
+        throw invalid_argument("compressed GT batch decoding failed");
+    }
+    for(size_t i = 0; i < elems.size(); i++)
+    {
+        if(!(*batchBE)[i].equal(elems[i]) || !(*batchLE)[i].equal(elems[i]))
+        {
+            throw invalid_argument("compressed GT batch decoding mismatch");
+        }
+    }
+    // invalid flags and non-canonical identity encodings are rejected
+    array<uint8_t, 288> bad = be[2];
+    bad[0] |= 0x80;
+    if(fp12::fromCompressedBytesBE(bad))
+    {
+        throw invalid_argument("compressed GT with invalid flag accepted");
+    }
+    bad = be[0];
+    bad[287] = 1;
+    if(fp12::fromCompressedBytesBE(bad))
+    {
+        throw invalid_argument("non-canonical compressed GT identity accepted");
+    }
+}
+
+void TestGtValidity()
+{
+    // the fast membership test must agree with exponentiation by the group order
+    vector<tuple<g1, g2>> v;
+    pairing::add_pair(v, random_g1(), random_g2());
+    fp12 gt = pairing::calculate(v);
+    fp12 f = random_fe12();
+    fp12 cyclotomic = f.conjugate().multiply(f.inverse());
+    cyclotomic = cyclotomic.frobeniusMap(2).multiply(cyclotomic);
+    for(const fp12& e : {gt, fp12::one(), gt.multiply(gt).conjugate(), f, cyclotomic, fp12::zero()})
+    {
+        if(e.isGtValid() != e.exp(fp::Q).isOne())
+        {
+            throw invalid_argument("isGtValid != (e^r == 1)");
+        }
+    }
+    if(!gt.isGtValid() || cyclotomic.isGtValid() || f.isGtValid() || fp12::zero().isGtValid())
+    {
+        throw invalid_argument("isGtValid, unexpected result");
+    }
+}
+
 void TestFieldElementHelpers()
 {
     // fe
@@ -1402,6 +1544,190 @@ void TestG2MapToCurve()
     }
 }
 
+void TestDoubleN()
+{
+    // doubleNAssign(k) must match k calls of doubleAssign, including k = 0 and the zero point
+    g1 p1 = random_g1();
+    g2 p2 = random_g2();
+    for(uint64_t k : {0, 1, 2, 5, 16, 63})
+    {
+        g1 a1 = p1, b1 = p1;
+        g2 a2 = p2, b2 = p2;
+        a1.doubleNAssign(k);
+        a2.doubleNAssign(k);
+        for(uint64_t i = 0; i < k; i++)
+        {
+            b1.doubleAssign();
+            b2.doubleAssign();
+        }
+        if(!a1.equal(b1) || !a2.equal(b2))
+        {
+            throw invalid_argument("doubleNAssign != repeated doubleAssign");
+        }
+    }
+    g1 z1 = g1::zero();
+    g2 z2 = g2::zero();
+    z1.doubleNAssign(7);
+    z2.doubleNAssign(7);
+    if(!z1.isZero() || !z2.isZero())
+    {
+        throw invalid_argument("doubleNAssign of zero is not zero");
+    }
+}
+
+void TestConstantChains()
+{
+    // the compile-time chains must agree with the generic double-and-add and square-and-multiply loops
+    static_assert(!scalar::digitChain<0xd201000000010000>::naf && scalar::digitChain<0xd201000000010000>::weight == 6);
+    static_assert(scalar::digitChain<0xff>::naf && scalar::digitChain<0xff>::weight == 2 && scalar::digitChain<0xff>::length == 9);
+    auto dbl = [](g1& r, uint64_t k) { r.doubleNAssign(k); };
+    auto add = [](g1& r, const g1& q) { r.addAssign(q); };
+    auto neg = [](const g1& q) { return q.negate(); };
+    for(int i = 0; i < 4; i++)
+    {
+        g1 p = random_g1();
+        if(!scalar::mulByConstant<0xff>(p, dbl, add, neg).equal(p.scale(array<uint64_t, 1>{0xff})) ||
+           !scalar::mulByConstant<0xb7f3>(p, dbl, add, neg).equal(p.scale(array<uint64_t, 1>{0xb7f3})) ||
+           !scalar::mulByConstant<1>(p, dbl, add, neg).equal(p))
+        {
+            throw invalid_argument("mulByConstant != scale");
+        }
+        if(!p.clearCofactor().equal(p.scale(g1::cofactorEFF)))
+        {
+            throw invalid_argument("g1::clearCofactor != scale(cofactorEFF)");
+        }
+        vector<tuple<g1, g2>> v;
+        pairing::add_pair(v, p, random_g2());
+        fp12 gt = pairing::calculate(v);
+        if(!gt.cyclotomicExpByX().equal(gt.cyclotomicExp(g2::cofactorEFF).conjugate()))
+        {
+            throw invalid_argument("cyclotomicExpByX != cyclotomicExp(x)");
+        }
+    }
+}
+
+void TestSubgroupCheckScott()
+{
+    // mulByX must match a generic multiplication by x, and the endomorphism checks must accept subgroup points,
+    // the zero point and reject points of the curve outside of the subgroup
+    const array<uint64_t, 1> absX = {0xd201000000010000};
+    for(int i = 0; i < 8; i++)
+    {
+        g1 p1 = g1::one().scale(random_scalar());
+        g2 p2 = g2::one().scale(random_scalar());
+        if(!p1.mulByX().equal(p1.scale(absX).negate()) || !p2.mulByX().equal(p2.scale(absX).negate()))
+        {
+            throw invalid_argument("mulByX != -|x| P");
+        }
+        if(!p1.inCorrectSubgroup() || !p2.inCorrectSubgroup())
+        {
+            throw invalid_argument("subgroup check rejected a subgroup point");
+        }
+        g1 q1 = g1::swuMap(random_fe()).isogenyMap();
+        g2 q2 = g2::swuMap(random_fe2()).isogenyMap();
+        if(!q1.isOnCurve() || q1.inCorrectSubgroup() || !q2.isOnCurve() || q2.inCorrectSubgroup())
+        {
+            throw invalid_argument("subgroup check accepted a point outside of the subgroup");
+        }
+        if(!q1.clearCofactor().inCorrectSubgroup() || !q2.clearCofactor().inCorrectSubgroup())
+        {
+            throw invalid_argument("subgroup check rejected a cleared point");
+        }
+    }
+    if(!g1::zero().inCorrectSubgroup() || !g2::zero().inCorrectSubgroup())
+    {
+        throw invalid_argument("subgroup check rejected the zero point");
+    }
+}
+
+void TestBatchSubgroupCheck()
+{
+    // points on the curve outside of the subgroup: mapped but without cleared cofactor
+    const size_t n = 600;
+    const vector<size_t> badIdx = {3, 250, 599};
+    {
+        vector<g1> points(n);
+        g1 base = g1::one().scale(random_scalar());
+        points[0] = base;
+        for(size_t i = 1; i < n; i++)
+        {
+            points[i] = points[i - 1].add(base);
+        }
+        if(!g1::batchInCorrectSubgroup(points) || !g1::batchFindNotInCorrectSubgroup(points).empty())
+        {
+            throw invalid_argument("g1 batch subgroup check rejected valid points");
+        }
+        for(size_t i : badIdx)
+        {
+            points[i] = g1::swuMap(random_fe()).isogenyMap();
+        }
+        if(g1::batchInCorrectSubgroup(points) || g1::batchFindNotInCorrectSubgroup(points) != badIdx)
+        {
+            throw invalid_argument("g1 batch subgroup check missed invalid points");
+        }
+        if(g1::batchInCorrectSubgroup(span<const g1>(points).first(10)) || !g1::batchInCorrectSubgroup(span<const g1>(points).first(3)))
+        {
+            throw invalid_argument("g1 batch subgroup check on a short span");
+        }
+    }
+    {
+        vector<g2> points(n);
+        g2 base = g2::one().scale(random_scalar());
+        points[0] = base;
+        for(size_t i = 1; i < n; i++)
+        {
+            points[i] = points[i - 1].add(base);
+        }
+        if(!g2::batchInCorrectSubgroup(points) || !g2::batchFindNotInCorrectSubgroup(points).empty())
+        {
+            throw invalid_argument("g2 batch subgroup check rejected valid points");
+        }
+        for(size_t i : badIdx)
+        {
+            points[i] = g2::swuMap(random_fe2()).isogenyMap();
+        }
+        if(g2::batchInCorrectSubgroup(points) || g2::batchFindNotInCorrectSubgroup(points) != badIdx)
+        {
+            throw invalid_argument("g2 batch subgroup check missed invalid points");
+        }
+    }
+}
+
+void TestSwuMapJacobian()
+{
+    // the inversion-free SWU map and the Jacobian isogeny must agree with their affine counterparts, including u = 0
+    for(int i = 0; i < 16; i++)
+    {
+        fp u1 = i == 0 ? fp::zero() : random_fe();
+        g1 p1 = g1::swuMap(u1);
+        auto [x1, y1] = g1::swuMapG1(u1);
+        g1 a1 = p1.affine();
+        if(!a1.x.equal(x1) || !a1.y.equal(y1) || a1.y.sign() != u1.sign())
+        {
+            throw invalid_argument("g1::swuMap != swuMapG1");
+        }
+        g1 q1 = p1.isogenyMap();
+        if(!q1.isOnCurve() || !q1.equal(a1.isogenyMap()))
+        {
+            throw invalid_argument("g1::isogenyMap of Jacobian point is wrong");
+        }
+
+        fp2 u2 = i == 0 ? fp2::zero() : random_fe2();
+        g2 p2 = g2::swuMap(u2);
+        auto [x2, y2] = g2::swuMapG2(u2);
+        g2 a2 = p2.affine();
+        if(!a2.x.equal(x2) || !a2.y.equal(y2) || a2.y.sign() != u2.sign())
+        {
+            throw invalid_argument("g2::swuMap != swuMapG2");
+        }
+        g2 q2 = p2.isogenyMap();
+        if(!q2.isOnCurve() || !q2.equal(a2.isogenyMap()))
+        {
+            throw invalid_argument("g2::isogenyMap of Jacobian point is wrong");
+        }
+    }
+}
+
 ///////////////////////////////////////////////////////////
 
 void TestPairingExpected()
@@ -1628,6 +1954,29 @@ void TestPairingMulti()
     {
         throw invalid_argument("fail multi pairing");
     }
+
+    // the line table of a single pair from pre_compute evaluates to the same Miller loop value
+    g1 P = get<g1>(v[0]);
+    array<array<fp2, 3>, 68> ell;
+    pairing::pre_compute(ell, get<g2>(v[0]));
+    fp12 f = fp12::one();
+    for(int64_t i = 64 - 2, k = 0; i >= 0; i--, k++)
+    {
+        if(i != 64 - 2)
+        {
+            f = f.square();
+        }
+        f.mulBy014Assign(ell[k][0], ell[k][1].mulByFq(P.x), ell[k][2].mulByFq(P.y));
+        if(((g2::cofactorEFF[0] >> i) & 1) == 1)
+        {
+            k++;
+            f.mulBy014Assign(ell[k][0], ell[k][1].mulByFq(P.x), ell[k][2].mulByFq(P.y));
+        }
+    }
+    if(!f.conjugate().equal(pairing::miller_loop(span<const tuple<g1, g2>>(v).first(1), std::function<void()>())))
+    {
+        throw invalid_argument("pre_compute line table mismatch");
+    }
 }
 
 ///////////////////////////////////////////////////////////
@@ -1759,6 +2108,94 @@ void TestUnhardenedHDKeys()
     }
 }
 
+void TestExpandMessageBatch()
+{
+    // the batched expansion must match expanding every message on its own, messages of
+    // different lengths end up in the same batch
+    random_device rd;
+    mt19937_64 gen(rd());
+    uniform_int_distribution<uint32_t> dis;
+    for(size_t n : {1, 7, 17, 40})
+    {
+        vector<vector<uint8_t>> msgs(n);
+        vector<span<const uint8_t>> spans(n);
+        for(size_t i = 0; i < n; i++)
+        {
+            msgs[i].resize(i * 13 % 150);
+            for(uint8_t& b : msgs[i])
+            {
+                b = dis(gen);
+            }
+            spans[i] = msgs[i];
+        }
+        for(int len : {32, 128, 256})
+        {
+            vector<uint8_t> batch(n * len);
+            vector<uint8_t> single(len);
+            if(xmd_sh256(batch.data(), len, spans, reinterpret_cast<const uint8_t*>(CIPHERSUITE_ID.data()), CIPHERSUITE_ID.size()) != 0)
+            {
+                throw invalid_argument("batch xmd_sh256 failed");
+            }
+            for(size_t i = 0; i < n; i++)
+            {
+                xmd_sh256(single.data(), len, msgs[i].data(), msgs[i].size(), reinterpret_cast<const uint8_t*>(CIPHERSUITE_ID.data()), CIPHERSUITE_ID.size());
+                if(memcmp(single.data(), batch.data() + i * len, len) != 0)
+                {
+                    throw invalid_argument("batch xmd_sh256 != xmd_sh256");
+                }
+            }
+        }
+    }
+}
+
+void TestExpander()
+{
+    // the cached expander must match xmd_sh256 for short and long DSTs
+    for(const string& dst : {CIPHERSUITE_ID, POP_CIPHERSUITE_ID, string("QUUX-V01-CS02"), string(200, 'D')})
+    {
+        xmd_expander xmd(dst);
+        for(size_t msgLen : {0, 1, 63, 64, 200})
+        {
+            vector<uint8_t> msg(msgLen, 0x5A);
+            for(int len : {1, 32, 100, 256})
+            {
+                vector<uint8_t> expected(len), actual(len);
+                xmd_sh256(expected.data(), len, msg.data(), msg.size(), reinterpret_cast<const uint8_t*>(dst.data()), dst.size());
+                if(xmd.expand(actual.data(), len, msg) != 0 || expected != actual)
+                {
+                    throw invalid_argument("xmd_expander != xmd_sh256");
+                }
+            }
+        }
+        // the batched expansion, with messages of different block counts hashed in lockstep
+        vector<vector<uint8_t>> msgs;
+        for(size_t k = 0; k < 20; k++)
+        {
+            msgs.push_back(vector<uint8_t>(k * 13, static_cast<uint8_t>(k)));
+        }
+        vector<span<const uint8_t>> spans(msgs.begin(), msgs.end());
+        vector<uint8_t> batched(msgs.size() * 256), single(256);
+        if(xmd.expand(batched.data(), 256, spans) != 0)
+        {
+            throw invalid_argument("batched xmd_expander failed");
+        }
+        for(size_t k = 0; k < msgs.size(); k++)
+        {
+            xmd.expand(single.data(), 256, msgs[k]);
+            if(!equal(single.begin(), single.end(), batched.begin() + k * 256))
+            {
+                throw invalid_argument("batched xmd_expander != xmd_expander");
+            }
+        }
+    }
+    vector<uint8_t> msg = {1, 2, 3};
+    xmd_expander xmd("custom DST");
+    if(!fromMessage(msg, xmd).equal(fromMessage(msg, string("custom DST"))))
+    {
+        throw invalid_argument("fromMessage with expander != fromMessage with DST");
+    }
+}
+
 void TestIETFVectors()
 {
     string sig1BasicHex = "96ba34fac33c7f129d602a0bc8a3d43f9abc014eceaab7359146b4b150e57b808645738f35671e9e10e0d862a30cab70074eb5831d13e6a5b162d01eebe687d0164adbd0a864370a7c222a2768d7704da254f1bf1823665bc2361f9dd8c00e99";
@@ -1861,6 +2298,435 @@ void TestChiaVectors2()
     }
 }
 
+void TestFromMessages()
+{
+    vector<vector<uint8_t>> msgs;
+    for(size_t i = 0; i < 9; i++)
+    {
+        msgs.push_back(vector<uint8_t>(i * 7, static_cast<uint8_t>(i)));
+    }
+    vector<span<const uint8_t>> spans(msgs.begin(), msgs.end());
+    // the ciphersuite DSTs take the precomputed expanders, any other DST the batched expansion
+    for(const string& dst : {CIPHERSUITE_ID, POP_CIPHERSUITE_ID, string("QUUX-V01-CS02-with-BLS12381G2_XMD:SHA-256_SSWU_RO_")})
+    {
+        for(size_t threads : {1, 3, 16})
+        {
+            vector<g2> hashes = fromMessages(spans, dst, threads);
+            if(hashes.size() != msgs.size())
+            {
+                throw invalid_argument("fromMessages returned wrong number of points");
+            }
+            for(size_t i = 0; i < msgs.size(); i++)
+            {
+                if(!hashes[i].equal(fromMessage(msgs[i], dst)))
+                {
+                    throw invalid_argument("fromMessages != fromMessage");
+                }
+            }
+        }
+    }
+}
+
+void TestAffineTypes()
+{
+    static_assert(sizeof(g1_affine) == 96 && sizeof(g2_affine) == 192);
+    const size_t n = 40;
+    vector<g1> p1(n);
+    vector<g2> p2(n);
+    vector<array<uint64_t, 4>> scalars(n);
+    for(size_t i = 0; i < n; i++)
+    {
+        p1[i] = random_g1().dbl();
+        p2[i] = random_g2().dbl();
+        scalars[i] = random_scalar();
+    }
+    p1[7] = g1::zero();
+    p2[7] = g2::zero();
+    vector<g1_affine> a1 = g1_affine::fromJacobian(p1);
+    vector<g2_affine> a2 = g2_affine::fromJacobian(p2);
+    for(size_t i = 0; i < n; i++)
+    {
+        if(!a1[i].toJacobian().equal(p1[i]) || !a1[i].equal(g1_affine(p1[i])) || !a1[i].isOnCurve() ||
+           !a2[i].toJacobian().equal(p2[i]) || !a2[i].equal(g2_affine(p2[i])) || !a2[i].isOnCurve())
+        {
+            throw invalid_argument("affine conversion mismatch");
+        }
+    }
+    if(!a1[7].isZero() || !a2[7].isZero())
+    {
+        throw invalid_argument("zero point not converted to the affine zero");
+    }
+
+    // mixed additions, including the zero, doubling and inverse cases
+    for(size_t i = 0; i < n; i++)
+    {
+        size_t j = (i + 1) % n;
+        if(!p1[i].add(a1[j]).equal(p1[i].add(p1[j])) || !p2[i].add(a2[j]).equal(p2[i].add(p2[j])) ||
+           !p1[i].add(a1[i]).equal(p1[i].dbl()) || !p2[i].add(a2[i]).equal(p2[i].dbl()) ||
+           !p1[i].add(a1[i].negate()).isZero() || !p2[i].add(a2[i].negate()).isZero())
+        {
+            throw invalid_argument("mixed addition mismatch");
+        }
+    }
+
+    if(!g1::weightedSum(a1, scalars).equal(g1::weightedSum(p1, scalars)) ||
+       !g2::weightedSum(a2, scalars).equal(g2::weightedSum(p2, scalars)))
+    {
+        throw invalid_argument("affine weightedSum mismatch");
+    }
+    if(!aggregate_public_keys(a1).equal(aggregate_public_keys(p1)) ||
+       !aggregate_public_keys_g2(a2).equal(aggregate_public_keys_g2(p2)))
+    {
+        throw invalid_argument("affine aggregate_public_keys mismatch");
+    }
+
+    vector<tuple<g1, g2>> v;
+    vector<tuple<g1_affine, g2_affine>> va;
+    for(size_t i = 0; i < 3; i++)
+    {
+        pairing::add_pair(v, p1[i], p2[i]);
+        va.emplace_back(a1[i], a2[i]);
+    }
+    if(!pairing::calculate(va).equal(pairing::calculate(v)))
+    {
+        throw invalid_argument("affine pairing mismatch");
+    }
+
+    vector<g1> pks(4);
+    vector<g2> sigs(4);
+    vector<vector<uint8_t>> msgs(4);
+    for(size_t i = 0; i < 4; i++)
+    {
+        array<uint64_t, 4> sk = random_scalar();
+        msgs[i] = vector<uint8_t>(i + 1, static_cast<uint8_t>(i));
+        pks[i] = public_key(sk);
+        sigs[i] = sign(sk, msgs[i]);
+    }
+    vector<span<const uint8_t>> spans(msgs.begin(), msgs.end());
+    vector<g1_affine> apks = g1_affine::fromJacobian(pks);
+    vector<g2_affine> asigs = g2_affine::fromJacobian(sigs);
+    if(!batch_verify(apks, spans, asigs))
+    {
+        throw invalid_argument("affine batch_verify failed on valid signatures");
+    }
+    swap(asigs[0], asigs[3]);
+    if(batch_verify_find_invalid(apks, spans, asigs) != vector<size_t>{0, 3})
+    {
+        throw invalid_argument("affine batch_verify_find_invalid missed invalid signatures");
+    }
+}
+
+void TestBatchEncoding()
+{
+    // the batch encoders must match the single point ones, including the zero point
+    const size_t n = 30;
+    vector<g1> p1(n);
+    vector<g2> p2(n);
+    for(size_t i = 0; i < n; i++)
+    {
+        p1[i] = i == 4 ? g1::zero() : random_g1().dbl();
+        p2[i] = i == 4 ? g2::zero() : random_g2().dbl();
+    }
+    vector<uint8_t> c1(48 * n), a1(96 * n), l1(96 * n), c2(96 * n), a2(192 * n), l2(192 * n);
+    if(!g1::toCompressedBytesBE(p1, c1) || !g1::toAffineBytesBE(p1, a1) || !g1::toAffineBytesLE(p1, l1, from_mont::no) ||
+       !g2::toCompressedBytesBE(p2, c2) || !g2::toAffineBytesBE(p2, a2) || !g2::toAffineBytesLE(p2, l2, from_mont::no))
+    {
+        throw invalid_argument("batch encoding failed");
+    }
+    for(size_t i = 0; i < n; i++)
+    {
+        if(!equal(c1.begin() + 48 * i, c1.begin() + 48 * (i + 1), p1[i].toCompressedBytesBE().begin()) ||
+           !equal(a1.begin() + 96 * i, a1.begin() + 96 * (i + 1), p1[i].toAffineBytesBE().begin()) ||
+           !equal(l1.begin() + 96 * i, l1.begin() + 96 * (i + 1), p1[i].toAffineBytesLE(from_mont::no).begin()) ||
+           !equal(c2.begin() + 96 * i, c2.begin() + 96 * (i + 1), p2[i].toCompressedBytesBE().begin()) ||
+           !equal(a2.begin() + 192 * i, a2.begin() + 192 * (i + 1), p2[i].toAffineBytesBE().begin()) ||
+           !equal(l2.begin() + 192 * i, l2.begin() + 192 * (i + 1), p2[i].toAffineBytesLE(from_mont::no).begin()))
+        {
+            throw invalid_argument("batch encoding mismatch");
+        }
+    }
+    // the zero point is encoded as infinity and survives the round trip
+    vector<g1> d1(n);
+    vector<g2> d2(n);
+    if(c1[48 * 4] != 0xC0 || c2[96 * 4] != 0xC0 ||
+       !g1::fromCompressedBytesBE(c1, d1, 2, true) || !g2::fromCompressedBytesBE(c2, d2, 2, true) ||
+       !d1[4].isZero() || !d2[4].isZero() || !d1[7].equal(p1[7]) || !d2[7].equal(p2[7]))
+    {
+        throw invalid_argument("batch encoding round trip");
+    }
+    if(g1::toCompressedBytesBE(p1, span<uint8_t>(c1).first(48 * n - 1)) || g2::toAffineBytesBE(p2, span<uint8_t>(a2).first(192)))
+    {
+        throw invalid_argument("batch encoding accepted a mismatched buffer");
+    }
+}
+
+void TestBatchDecompression()
+{
+    const size_t n = 600;
+    vector<g1> p1(n);
+    vector<g2> p2(n);
+    vector<uint8_t> packed1(48 * n), packed2(96 * n);
+    p1[0] = random_g1();
+    p2[0] = random_g2();
+    for(size_t i = 1; i < n; i++)
+    {
+        p1[i] = p1[i - 1].add(p1[0]);
+        p2[i] = p2[i - 1].add(p2[0]);
+    }
+    for(size_t i = 0; i < n; i++)
+    {
+        p1[i].toCompressedBytesBE(span<uint8_t, 48>(&packed1[48 * i], 48));
+        p2[i].toCompressedBytesBE(span<uint8_t, 96>(&packed2[96 * i], 96));
+    }
+    for(size_t threads : {1, 4})
+    {
+        vector<g1> out1(n);
+        vector<g2> out2(n);
+        if(!g1::fromCompressedBytesBE(packed1, out1, threads, true) || !g2::fromCompressedBytesBE(packed2, out2, threads, true))
+        {
+            throw invalid_argument("batch decompression failed");
+        }
+        for(size_t i = 0; i < n; i++)
+        {
+            if(!out1[i].equal(p1[i]) || !out2[i].equal(p2[i]))
+            {
+                throw invalid_argument("batch decompression mismatch");
+            }
+        }
+    }
+
+    vector<g1> out1(n);
+    vector<g2> out2(n);
+    if(g1::fromCompressedBytesBE(span<const uint8_t>(packed1).first(48 * n - 1), out1) ||
+       g2::fromCompressedBytesBE(packed2, span<g2>(out2).first(n - 1)))
+    {
+        throw invalid_argument("batch decompression accepted mismatched sizes");
+    }
+    // a point on the curve but outside of the subgroup only fails with the subgroup check
+    g1::swuMap(random_fe()).isogenyMap().toCompressedBytesBE(span<uint8_t, 48>(&packed1[48 * 500], 48));
+    g2::swuMap(random_fe2()).isogenyMap().toCompressedBytesBE(span<uint8_t, 96>(&packed2[96 * 500], 96));
+    if(!g1::fromCompressedBytesBE(packed1, out1, 4) || g1::fromCompressedBytesBE(packed1, out1, 4, true) ||
+       !g2::fromCompressedBytesBE(packed2, out2, 4) || g2::fromCompressedBytesBE(packed2, out2, 4, true))
+    {
+        throw invalid_argument("batch decompression subgroup check");
+    }
+    // an invalid encoding (compression bit cleared)
+    packed1[48 * 17] &= 0x7f;
+    packed2[96 * 17] &= 0x7f;
+    if(g1::fromCompressedBytesBE(packed1, out1, 4) || g2::fromCompressedBytesBE(packed2, out2, 4))
+    {
+        throw invalid_argument("batch decompression accepted an invalid encoding");
+    }
+}
+
+void TestPubkeyRegistry()
+{
+    const string path = (filesystem::temp_directory_path() / "bls12-381-registry-test.bin").string();
+    const size_t n = 20;
+    vector<g1> pks(n);
+    vector<array<uint64_t, 4>> sks(n);
+    for(size_t i = 0; i < n; i++)
+    {
+        sks[i] = random_scalar();
+        pks[i] = public_key(sks[i]).dbl().add(public_key(sks[i]).negate());   // a non-affine representation
+    }
+    if(!pubkey_registry::write(path, pks))
+    {
+        throw invalid_argument("registry write failed");
+    }
+    {
+        optional<pubkey_registry> r = pubkey_registry::open(path);
+        if(!r || r->size() != n)
+        {
+            throw invalid_argument("registry open failed");
+        }
+        vector<uint8_t> msg = {1, 2, 3};
+        for(size_t i = 0; i < n; i++)
+        {
+            g1 viaBytes = *g1::fromAffineBytesLE(r->keys()[i].toJacobian().toAffineBytesLE(from_mont::no), {.check_valid = false, .to_mont = false});
+            if(!(*r)[i].toJacobian().equal(pks[i]) || !viaBytes.equal(pks[i]))
+            {
+                throw invalid_argument("registry key mismatch");
+            }
+            if(!r->validated(i) || !verify(*r->validated(i), msg, sign(sks[i], msg)))
+            {
+                throw invalid_argument("registry key does not verify");
+            }
+        }
+        pubkey_registry moved = std::move(*r);
+        if(moved.size() != n || !moved[n - 1].toJacobian().equal(pks[n - 1]))
+        {
+            throw invalid_argument("moved registry mismatch");
+        }
+    }
+
+    // without the checksum every key handed out as validated is checked
+    {
+        optional<pubkey_registry> r = pubkey_registry::openUnverified(path);
+        if(!r || r->size() != n || !r->validated(n - 1) || !r->validated(n - 1)->point().equal(pks[n - 1]))
+        {
+            throw invalid_argument("unverified registry open failed");
+        }
+    }
+
+    // a flipped bit in a key record is caught by the checksum, or by validated() if the checksum is skipped
+    {
+        fstream f(path, ios::in | ios::out | ios::binary);
+        f.seekp(64 + 5 * 96 + 7);
+        f.put(0x55);
+    }
+    {
+        optional<pubkey_registry> r = pubkey_registry::openUnverified(path);
+        if(pubkey_registry::open(path) || !r || r->validated(5) || !r->validated(4))
+        {
+            throw invalid_argument("corrupted registry key accepted");
+        }
+    }
+    // truncated file
+    filesystem::resize_file(path, 64 + 3 * 96 + 1);
+    if(pubkey_registry::openUnverified(path) || pubkey_registry::open(path + ".missing"))
+    {
+        throw invalid_argument("malformed registry accepted");
+    }
+
+    // keys outside of the subgroup or the zero point are not written
+    pks[3] = g1::swuMap(random_fe()).isogenyMap();
+    vector<g1> withZero = {pks[0], g1::zero()};
+    if(pubkey_registry::write(path, pks) || pubkey_registry::write(path, withZero))
+    {
+        throw invalid_argument("registry written with invalid keys");
+    }
+    filesystem::remove(path);
+}
+
+void TestBatchVerify()
+{
+    const size_t n = 8;
+    vector<g1> pks(n);
+    vector<g2> sigs(n);
+    vector<vector<uint8_t>> msgs(n);
+    for(size_t i = 0; i < n; i++)
+    {
+        array<uint64_t, 4> sk = random_scalar();
+        msgs[i] = vector<uint8_t>(i + 1, static_cast<uint8_t>(i));
+        pks[i] = public_key(sk);
+        sigs[i] = sign(sk, msgs[i]);
+    }
+    vector<span<const uint8_t>> spans(msgs.begin(), msgs.end());
+    if(!batch_verify(pks, spans, sigs))
+    {
+        throw invalid_argument("batch_verify failed on valid signatures");
+    }
+
+    // two swapped signatures are both invalid, the random weights must keep them from cancelling out
+    swap(sigs[2], sigs[5]);
+    if(batch_verify(pks, spans, sigs))
+    {
+        throw invalid_argument("batch_verify accepted swapped signatures");
+    }
+    swap(sigs[2], sigs[5]);
+
+    if(batch_verify(span<const g1>(pks).first(n - 1), spans, sigs) || batch_verify(span<const g1>(), {}, span<const g2>()))
+    {
+        throw invalid_argument("batch_verify accepted mismatched or empty input");
+    }
+
+    // bisection must return exactly the bad indices, including ones rejected by the point checks
+    if(batch_verify_find_invalid(pks, spans, sigs) != vector<size_t>{})
+    {
+        throw invalid_argument("batch_verify_find_invalid reported valid signatures");
+    }
+    sigs[1] = sigs[1].dbl();
+    sigs[6] = sigs[0];
+    pks[4].y = pks[4].y.add(fp::one());
+    if(batch_verify_find_invalid(pks, spans, sigs) != vector<size_t>{1, 4, 6})
+    {
+        throw invalid_argument("batch_verify_find_invalid did not find the invalid signatures");
+    }
+    if(batch_verify_find_invalid(span<const g1>(pks).first(n - 1), spans, sigs).has_value())
+    {
+        throw invalid_argument("batch_verify_find_invalid accepted mismatched input");
+    }
+}
+
+void TestAggregateVerifyThreads()
+{
+    const size_t n = 7;
+    vector<g1> pks(n);
+    vector<g2> sigs(n);
+    vector<vector<uint8_t>> msgs(n);
+    for(size_t i = 0; i < n; i++)
+    {
+        array<uint64_t, 4> sk = random_scalar();
+        msgs[i] = vector<uint8_t>(8, static_cast<uint8_t>(i));
+        pks[i] = public_key(sk);
+        sigs[i] = sign(sk, msgs[i]);
+    }
+    g2 aggSig = aggregate_signatures(sigs);
+
+    // several keys signing the same message are grouped into one pair, the duplicate check must still see them
+    vector<vector<uint8_t>> dupMsgs = {msgs[0], msgs[1], msgs[0], msgs[2], msgs[1], msgs[0], msgs[3]};
+    vector<g2> dupSigs(n);
+    vector<array<uint64_t, 4>> dupSks(n);
+    vector<g1> dupPks(n);
+    vector<g2> dupPksG2(n);
+    vector<g1> dupSigsG1(n);
+    for(size_t i = 0; i < n; i++)
+    {
+        dupSks[i] = random_scalar();
+        dupPks[i] = public_key(dupSks[i]);
+        dupSigs[i] = sign(dupSks[i], dupMsgs[i]);
+        dupPksG2[i] = public_key_g2(dupSks[i]);
+        dupSigsG1[i] = sign_g1(dupSks[i], dupMsgs[i]);
+    }
+    g2 dupAggSig = aggregate_signatures(dupSigs);
+    g1 dupAggSigG1 = aggregate_signatures_g1(dupSigsG1);
+    if(!aggregate_verify(dupPks, dupMsgs, dupAggSig, false, 2) || aggregate_verify(dupPks, dupMsgs, dupAggSig, true, 2))
+    {
+        throw invalid_argument("aggregate_verify with repeated messages failed");
+    }
+    swap(dupPks[1], dupPks[2]);
+    if(aggregate_verify(dupPks, dupMsgs, dupAggSig, false, 2))
+    {
+        throw invalid_argument("aggregate_verify accepted keys swapped across messages");
+    }
+    if(!aggregate_verify_g1(dupPksG2, dupMsgs, dupAggSigG1) || aggregate_verify_g1(dupPksG2, dupMsgs, dupAggSigG1, true))
+    {
+        throw invalid_argument("aggregate_verify_g1 with repeated messages failed");
+    }
+
+    for(size_t threads : {1, 2, 3, 16})
+    {
+        if(!aggregate_verify(pks, msgs, aggSig, true, threads))
+        {
+            throw invalid_argument("threaded aggregate_verify failed");
+        }
+        vector<g1> badPks = pks;
+        badPks[n - 1] = badPks[n - 1].add(g1::one());
+        if(aggregate_verify(badPks, msgs, aggSig, false, threads))
+        {
+            throw invalid_argument("threaded aggregate_verify accepted a wrong public key");
+        }
+        badPks[n - 1].y = badPks[n - 1].y.add(fp::one());
+        if(aggregate_verify(badPks, msgs, aggSig, false, threads))
+        {
+            throw invalid_argument("threaded aggregate_verify accepted an invalid public key");
+        }
+        // keys that cancel out on a message contribute no pair either
+        vector<g1> cancelling = {pks[0], pks[0].negate()};
+        vector<vector<uint8_t>> sameMsg = {msgs[0], msgs[0]};
+        if(!aggregate_verify(cancelling, sameMsg, g2::zero(), false, threads))
+        {
+            throw invalid_argument("threaded aggregate_verify with cancelling keys failed");
+        }
+        // the identity signature contributes no pair
+        if(!aggregate_verify(span<const g1>(), {}, g2::zero(), true, threads) || aggregate_verify(pks, msgs, g2::zero(), true, threads))
+        {
+            throw invalid_argument("threaded aggregate_verify with the identity signature failed");
+        }
+    }
+}
+
 void TestSignatures()
 {
     {
@@ -2048,6 +2914,141 @@ void TestAggregateSKs()
     if(!aggregate_verify(std::array{aggPubKey, pk2}, vector<vector<uint8_t>>{message, message2}, aggSigFinal, true)) throw invalid_argument("verify with aggPubKey failed");
 }
 
+void TestHashToG1()
+{
+    // https://www.rfc-editor.org/rfc/rfc9380#appendix-J.9.1
+    const string dst = "QUUX-V01-CS02-with-BLS12381G1_XMD:SHA-256_SSWU_RO_";
+    struct testVector
+    {
+        string msg;
+        string x;
+        string y;
+    } vectors[] = {
+        {
+            "",
+            "052926add2207b76ca4fa57a8734416c8dc95e24501772c814278700eed6d1e4e8cf62d9c09db0fac349612b759e79a1",
+            "08ba738453bfed09cb546dbb0783dbb3a5f1f566ed67bb6be0e8c67e2e81a4cc68ee29813bb7994998f3eae0c9c6a265"
+        },
+        {
+            "abc",
+            "03567bc5ef9c690c2ab2ecdf6a96ef1c139cc0b2f284dca0a9a7943388a49a3aee664ba5379a7655d3c68900be2f6903",
+            "0b9c15f3fe6e5cf4211f346271d7b01c8f3b28be689c8429c85b67af215533311f0b8dfaaa154fa6b88176c229f2885d"
+        },
+    };
+    for(const auto& v : vectors)
+    {
+        g1 expected({fp::fromBytesBE(hexToBytes<48>(v.x)).value(), fp::fromBytesBE(hexToBytes<48>(v.y)).value(), fp::one()});
+        g1 p = fromMessageG1(span<const uint8_t>(reinterpret_cast<const uint8_t*>(v.msg.data()), v.msg.size()), dst);
+        if(!p.equal(expected))
+        {
+            throw invalid_argument("fromMessageG1 does not match the RFC 9380 test vector");
+        }
+    }
+}
+
+void TestMinSigScheme()
+{
+    vector<uint8_t> seed1(32, 0x06);
+    vector<uint8_t> seed2(32, 0x07);
+    vector<uint8_t> msg1 = {7, 8, 9};
+    vector<uint8_t> msg2 = {10, 11, 12};
+    vector<vector<uint8_t>> msgs = {msg1, msg2};
+
+    array<uint64_t, 4> sk1 = secret_key(seed1);
+    g2 pk1 = public_key_g2(sk1);
+    g1 sig1 = sign_g1(sk1, msg1);
+
+    if(!verify_g1(pk1, msg1, sig1)) throw invalid_argument("verify_g1 failed");
+    if(!fromMessageG1(msg1, CIPHERSUITE_ID_G1).equal(fromMessageG1(msg1, xmd_expander(CIPHERSUITE_ID_G1)))) throw invalid_argument("fromMessageG1 expander mismatch");
+
+    array<uint64_t, 4> sk2 = secret_key(seed2);
+    g2 pk2 = public_key_g2(sk2);
+    g1 sig2 = sign_g1(sk2, msg2);
+
+    if(verify_g1(pk1, msg1, sig2)) throw invalid_argument("must fail: wrong sig");
+    if(verify_g1(pk1, msg2, sig1)) throw invalid_argument("must fail: wrong msg");
+    if(verify_g1(pk2, msg1, sig1)) throw invalid_argument("must fail: wrong pk");
+
+    g1 aggsig = aggregate_signatures_g1(std::array{sig1, sig2});
+    if(!aggregate_verify_g1(std::array{pk1, pk2}, msgs, aggsig, true)) throw invalid_argument("aggregate_verify_g1 failed");
+    if(aggregate_verify_g1(std::array{pk2, pk1}, msgs, aggsig)) throw invalid_argument("must fail: swapped pks");
+
+    g1 proof1 = pop_prove_g1(sk1);
+    if(!pop_verify_g1(pk1, proof1)) throw invalid_argument("pop_verify_g1 failed");
+    if(pop_verify_g1(pk2, proof1)) throw invalid_argument("must fail: wrong pop");
+
+    g1 sig2_same = sign_g1(sk2, msg1);
+    g1 aggsig_same = aggregate_signatures_g1(std::array{sig1, sig2_same});
+    if(!pop_fast_aggregate_verify_g1(std::array{pk1, pk2}, msg1, aggsig_same)) throw invalid_argument("pop_fast_aggregate_verify_g1 failed");
+    if(pop_fast_aggregate_verify_g1(std::array{pk1, pk2}, msg2, aggsig_same)) throw invalid_argument("must fail: wrong msg");
+}
+
+void TestValidatedKeys()
+{
+    vector<uint8_t> msg1 = {7, 8, 9};
+    vector<uint8_t> msg2 = {10, 11, 12};
+    vector<vector<uint8_t>> msgs = {msg1, msg2};
+    array<uint64_t, 4> sk1 = random_scalar();
+    array<uint64_t, 4> sk2 = random_scalar();
+
+    g1 bad = public_key(sk1);
+    bad.y = bad.y.add(fp::one());
+    if(validated_g1::validate(bad).has_value() || validated_g2::validate(g2({fp2::one(), fp2::one(), fp2::one()})).has_value())
+    {
+        throw invalid_argument("validate accepted a point that is not on the curve");
+    }
+
+    validated_g1 pk1 = validated_g1::validate(public_key(sk1)).value();
+    validated_g1 pk2 = validated_g1::validate(public_key(sk2).dbl().add(public_key(sk2).negate())).value();
+    if(!pk1.point().isAffine() || !pk2.point().equal(public_key(sk2)))
+    {
+        throw invalid_argument("validated_g1 does not hold the affine point");
+    }
+    g2 sig1 = sign(sk1, msg1);
+    g2 sig2 = sign(sk2, msg2);
+    if(!verify(pk1, msg1, sig1) || verify(pk1, msg2, sig1) || verify(pk2, msg1, sig1))
+    {
+        throw invalid_argument("verify with validated key");
+    }
+    g2 aggSig = aggregate_signatures(std::array{sig1, sig2});
+    if(!aggregate_verify(std::array{pk1, pk2}, msgs, aggSig) || aggregate_verify(std::array{pk2, pk1}, msgs, aggSig))
+    {
+        throw invalid_argument("aggregate_verify with validated keys");
+    }
+    if(!pop_verify(pk1, pop_prove(sk1)) || pop_verify(pk2, pop_prove(sk1)))
+    {
+        throw invalid_argument("pop_verify with validated key");
+    }
+    g2 aggSame = aggregate_signatures(std::array{sig1, sign(sk2, msg1)});
+    if(!pop_fast_aggregate_verify(std::array{pk1, pk2}, msg1, aggSame) || pop_fast_aggregate_verify(std::array{pk1, pk2}, msg2, aggSame))
+    {
+        throw invalid_argument("pop_fast_aggregate_verify with validated keys");
+    }
+
+    // minimal-signature-size variant
+    validated_g2 qk1 = validated_g2::validate(public_key_g2(sk1)).value();
+    validated_g2 qk2 = validated_g2::validate(public_key_g2(sk2)).value();
+    g1 sigG1 = sign_g1(sk1, msg1);
+    if(!verify_g1(qk1, msg1, sigG1) || verify_g1(qk2, msg1, sigG1))
+    {
+        throw invalid_argument("verify_g1 with validated key");
+    }
+    g1 aggSigG1 = aggregate_signatures_g1(std::array{sigG1, sign_g1(sk2, msg2)});
+    if(!aggregate_verify_g1(std::array{qk1, qk2}, msgs, aggSigG1) || aggregate_verify_g1(std::array{qk2, qk1}, msgs, aggSigG1))
+    {
+        throw invalid_argument("aggregate_verify_g1 with validated keys");
+    }
+    if(!pop_verify_g1(qk1, pop_prove_g1(sk1)) || pop_verify_g1(qk2, pop_prove_g1(sk1)))
+    {
+        throw invalid_argument("pop_verify_g1 with validated key");
+    }
+    g1 aggSameG1 = aggregate_signatures_g1(std::array{sigG1, sign_g1(sk2, msg1)});
+    if(!pop_fast_aggregate_verify_g1(std::array{qk1, qk2}, msg1, aggSameG1))
+    {
+        throw invalid_argument("pop_fast_aggregate_verify_g1 with validated keys");
+    }
+}
+
 void TestPopScheme()
 {
     {
@@ -2314,6 +3315,8 @@ int main()
     TestInverse();
     TestMod();
     TestExp();
+    TestSparseMultiplication();
+    TestCyclotomicCompressed();
 
     TestG1Serialization();
     TestG1SerializationGarbage();
@@ -2333,22 +3336,41 @@ int main()
     TestG2WeightedSumExpected();
     TestG2WeightedSumBatch();
     TestG2MapToCurve();
+    TestSwuMapJacobian();
+    TestDoubleN();
+    TestConstantChains();
+    TestSubgroupCheckScott();
+    TestBatchSubgroupCheck();
 
     TestPairingExpected();
     TestPairingNonDegeneracy();
     TestPairingBilinearity();
     TestPairingMulti();
+    TestGtValidity();
+    TestGtCompression();
 
     TestsEIP2333();
     TestUnhardenedHDKeys();
     TestIETFVectors();
+    TestExpandMessageBatch();
+    TestExpander();
     TestChiaVectors();
     TestChiaVectors2();
 
+    TestFromMessages();
     TestSignatures();
+    TestBatchVerify();
+    TestAffineTypes();
+    TestPubkeyRegistry();
+    TestBatchDecompression();
+    TestBatchEncoding();
+    TestAggregateVerifyThreads();
     TestAugScheme();
     TestAggregateSKs();
     TestPopScheme();
+    TestHashToG1();
+    TestMinSigScheme();
+    TestValidatedKeys();
 
     TestExtraVectors();
     TestOutOfRangeInputs();